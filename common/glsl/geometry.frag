@@ -1,18 +1,38 @@
-#version 330 core
-layout (location = 0) out vec3 gPosition;
-layout (location = 1) out vec3 gNormal;
-layout (location = 2) out vec4 gAlbedoSpec;
+#version 330
 
-in vec2 TexCoords;
-in vec3 FragPos;
-in vec3 Normal;
+in vec4 normalViewSpace;
+in vec4 posViewSpace;
+in vec2 vertexTexCoords;
+
+//view space normal that faces the camera, w is 1 for front faces and 0 for back faces
+layout(location = 0) out vec4 gNormal;
+layout(location = 1) out vec4 gAlbedo;
+
+uniform vec4 color;
+
+uniform bool flatShading;
+uniform bool perFaceColor;
+//RGBA8 color of every triangle of the draw call
+uniform samplerBuffer faceColors;
+uniform bool visualizeTexCoords;
 
 void main()
 {
-    // store the fragment position vector in the first gbuffer texture
-    gPosition = FragPos;
-    // also store the per-fragment normals into the gbuffer
-    gNormal = normalize(Normal);
-    // and the diffuse per-fragment color
-    gAlbedoSpec.rgb = vec3(0.95);
-}
\ No newline at end of file
+	vec3 normal = normalize(normalViewSpace.xyz);
+	if(flatShading)
+		normal = normalize(cross(dFdx(posViewSpace.xyz), dFdy(posViewSpace.xyz)));
+	if(dot(normal, posViewSpace.xyz) > 0)
+		normal = -normal;
+	gNormal = vec4(normal, gl_FrontFacing ? 1 : 0);
+
+	vec4 materialColor = perFaceColor ? texelFetch(faceColors, gl_PrimitiveID) : color;
+
+	if(visualizeTexCoords)
+	{
+		int cellId = (int(20 * vertexTexCoords.x) + int(20 * vertexTexCoords.y)); 
+		if(cellId % 2 != 0)
+			materialColor.xyz *= 0.3; 
+	}
+
+	gAlbedo = vec4(materialColor.rgb, 1);
+}
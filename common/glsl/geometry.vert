@@ -1,16 +1,28 @@
-#version 130
+#version 330
 
-in vec4 position;
-in vec4 normal;
-in vec2 texCoords;
+//fixed locations, mesh.vert uses the same ones because both shaders draw the vertex array of the mesh
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 normal;
+layout(location = 2) in vec2 texCoords;
 
-out vec3 Normal;
-out vec3 FragPos;
-out vec2 TexCoords;
+out vec4 normalViewSpace;
+out vec4 posViewSpace;
+out vec2 vertexTexCoords;
+
+uniform mat4 view;
+uniform mat4 proj;
+
+//maps quantized positions to model space
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
 
 void main()
 {
-	TexCoords = texCoords;
-	FragPos = position.xyz;
-	Normal = normal.xyz;
+	posViewSpace = view * vec4(positionOffset + positionScale * position.xyz, 1);
+	//packed normals are not normalized, only the direction is used
+	normalViewSpace = view * vec4(normal.xyz, 0);
+
+	vertexTexCoords = texCoords;
+	
+	gl_Position = proj * posViewSpace;
 }
\ No newline at end of file
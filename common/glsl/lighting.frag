@@ -0,0 +1,83 @@
+#version 330
+
+out vec4 outColor;
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+//ambient occlusion in half resolution
+uniform sampler2D ssao;
+
+uniform mat4 invProj;
+//lower left corner of the viewport, the G-buffer covers the viewport
+uniform ivec2 viewportOrigin;
+
+vec3 ViewPosition(ivec2 texel, float depth)
+{
+	vec2 size = vec2(textureSize(gDepth, 0));
+	vec4 ndc = vec4(2 * (vec2(texel) + 0.5) / size - 1, 2 * depth - 1, 1);
+	vec4 position = invProj * ndc;
+	return position.xyz / position.w;
+}
+
+//Interpolates the four closest half resolution occlusion values. The bilinear weights are scaled down for samples
+//whose depth or normal differ from the fragment, so occlusion does not bleed across silhouettes.
+float UpsampleOcclusion(ivec2 texel, vec3 position, vec3 normal)
+{
+	ivec2 fullSize = textureSize(gDepth, 0);
+	ivec2 halfSize = textureSize(ssao, 0);
+	vec2 lowPosition = (vec2(texel) + 0.5) / 2 - 0.5;
+	ivec2 base = ivec2(floor(lowPosition));
+	vec2 f = lowPosition - vec2(base);
+
+	float occlusion = 0, weightSum = 0, bilinearOcclusion = 0;
+	for(int i = 0; i < 4; ++i)
+	{
+		ivec2 corner = ivec2(i & 1, i >> 1);
+		ivec2 lowTexel = clamp(base + corner, ivec2(0), halfSize - 1);
+		//the full resolution texel from which the SSAO pass took its position and normal
+		ivec2 sourceTexel = min(2 * lowTexel, fullSize - 1);
+		float lowDepth = texelFetch(gDepth, sourceTexel, 0).r;
+		vec3 lowNormal = texelFetch(gNormal, sourceTexel, 0).xyz;
+
+		vec2 bilinear = mix(1 - f, f, vec2(corner));
+		float bilinearWeight = bilinear.x * bilinear.y;
+		float depthDifference = abs(ViewPosition(sourceTexel, lowDepth).z - position.z) / max(abs(position.z), 1e-6);
+		float normalWeight = pow(max(dot(normal, lowNormal), 0.0), 8.0);
+		float weight = bilinearWeight * normalWeight / (1e-3 + depthDifference);
+		if(lowDepth == 1)
+			weight = 0;
+
+		float value = texelFetch(ssao, lowTexel, 0).r;
+		occlusion += weight * value;
+		weightSum += weight;
+		bilinearOcclusion += bilinearWeight * value;
+	}
+	return weightSum > 1e-6 ? occlusion / weightSum : bilinearOcclusion;
+}
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy) - viewportOrigin;
+	float depth = texelFetch(gDepth, texel, 0).r;
+	if(depth == 1)
+		discard;
+	//the lighting pass composes with other geometry like a forward pass
+	gl_FragDepth = depth;
+
+	vec4 normalAndFacing = texelFetch(gNormal, texel, 0);
+	vec3 normal = normalAndFacing.xyz;
+	vec3 position = ViewPosition(texel, depth);
+	vec3 toLight = normalize(-position);
+
+	float diffuse = abs(dot(normal, toLight));
+	float specular = pow(diffuse, 20);
+
+	if(normalAndFacing.w == 0)
+		diffuse *= 0.5;
+
+	diffuse *= UpsampleOcclusion(texel, position, normal);
+
+	outColor = diffuse * texelFetch(gAlbedo, texel, 0) + specular * vec4(0.5, 0.5, 0.5, 0);
+	outColor.a = 1;
+}
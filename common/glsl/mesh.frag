@@ -1,8 +1,7 @@
-#version 130
+#version 150
 
 in vec4 normalViewSpace;
 in vec4 posViewSpace;
-in vec4 vertexColor;
 in vec2 vertexTexCoords;
 
 out vec4 outColor;
@@ -10,7 +9,9 @@ out vec4 outColor;
 uniform vec4 color;
 
 uniform bool flatShading;
-uniform bool perVertexColor;
+uniform bool perFaceColor;
+//RGBA8 color of every triangle of the draw call
+uniform samplerBuffer faceColors;
 uniform bool visualizeTexCoords;
 
 void main()
@@ -26,7 +27,7 @@ void main()
 	if(!gl_FrontFacing)
 		diffuse *= 0.5;
 	
-	vec4 materialColor = perVertexColor ? vertexColor : color;
+	vec4 materialColor = perFaceColor ? texelFetch(faceColors, gl_PrimitiveID) : color;
 
 	if(visualizeTexCoords)
 	{
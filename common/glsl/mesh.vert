@@ -1,24 +1,27 @@
-#version 130
+#version 330
 
-in vec4 position;
-in vec4 normal;
-in vec4 color;
-in vec2 texCoords;
+//fixed locations, geometry.vert uses the same ones because both shaders draw the vertex array of the mesh
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 normal;
+layout(location = 2) in vec2 texCoords;
 
 out vec4 normalViewSpace;
 out vec4 posViewSpace;
-out vec4 vertexColor;
 out vec2 vertexTexCoords;
 
 uniform mat4 view;
 uniform mat4 proj;
 
+//maps quantized positions to model space
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
 void main()
 {
-	posViewSpace = view * position;
-	normalViewSpace = view * normal;
+	posViewSpace = view * vec4(positionOffset + positionScale * position.xyz, 1);
+	//packed normals are not normalized, only the direction is used
+	normalViewSpace = view * vec4(normal.xyz, 0);
 
-	vertexColor = color;
 	vertexTexCoords = texCoords;
 	
 	gl_Position = proj * posViewSpace;
@@ -1,56 +1,66 @@
-#version 330 core
-out float FragColor;
+#version 330
 
-in vec2 TexCoords;
+out float occlusion;
 
-uniform sampler2D gPosition;
+//the G-buffer in full resolution, this pass runs in half resolution
+uniform sampler2D gDepth;
 uniform sampler2D gNormal;
-uniform sampler2D texNoise;
+//random rotations of the kernel around the normal, tiled over the screen
+uniform sampler2D noise;
 
-uniform vec3 samples[64];
+const int kernelSize = 16;
+//sample offsets in the hemisphere around the z axis, denser close to the center
+uniform vec3 samples[kernelSize];
+//radius of the hemisphere in view space
+uniform float radius;
 
-// parameters (you'd probably want to use them as uniforms to more easily tweak the effect)
-int kernelSize = 64;
-float radius = 0.5;
-float bias = 0.025;
+uniform mat4 proj;
+uniform mat4 invProj;
 
-// tile noise texture over screen based on screen dimensions divided by noise size
-const vec2 noiseScale = vec2(1280.0/4.0, 720.0/4.0);
-
-uniform mat4 projection;
+//reconstructs the view space position of a G-buffer texel from its depth
+vec3 ViewPosition(ivec2 texel, float depth)
+{
+	vec2 size = vec2(textureSize(gDepth, 0));
+	vec4 ndc = vec4(2 * (vec2(texel) + 0.5) / size - 1, 2 * depth - 1, 1);
+	vec4 position = invProj * ndc;
+	return position.xyz / position.w;
+}
 
 void main()
 {
-    // get input for SSAO algorithm
-    vec3 fragPos = texture(gPosition, TexCoords).xyz;
-    vec3 normal = normalize(texture(gNormal, TexCoords).rgb);
-    vec3 randomVec = normalize(texture(texNoise, TexCoords * noiseScale).xyz);
-    // create TBN change-of-basis matrix: from tangent-space to view-space
-    vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
-    vec3 bitangent = cross(normal, tangent);
-    mat3 TBN = mat3(tangent, bitangent, normal);
-    // iterate over the sample kernel and calculate occlusion factor
-    float occlusion = 0.0;
-    for(int i = 0; i < kernelSize; ++i)
-    {
-        // get sample position
-        vec3 s = TBN * samples[i]; // from tangent to view-space
-        s = fragPos + s * radius;
-
-        // project sample position (to sample texture) (to get position on screen/texture)
-        vec4 offset = vec4(s, 1.0);
-        offset = projection * offset; // from view to clip-space
-        offset.xyz /= offset.w; // perspective divide
-        offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
-
-        // get sample depth
-        float sampleDepth = texture(gPosition, offset.xy).z; // get depth value of kernel sample
-
-        // range check & accumulate
-        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
-        occlusion += (sampleDepth >= s.z + bias ? 1.0 : 0.0) * rangeCheck;
-    }
-    occlusion = 1.0 - (occlusion / kernelSize);
-
-    FragColor = occlusion;
-}
\ No newline at end of file
+	ivec2 size = textureSize(gDepth, 0);
+	ivec2 texel = min(2 * ivec2(gl_FragCoord.xy), size - 1);
+	float depth = texelFetch(gDepth, texel, 0).r;
+	if(depth == 1)
+	{
+		occlusion = 1;
+		return;
+	}
+	vec3 fragPos = ViewPosition(texel, depth);
+	vec3 normal = texelFetch(gNormal, texel, 0).xyz;
+
+	//tangent space with a random rotation around the normal
+	vec3 randomVec = vec3(texelFetch(noise, ivec2(gl_FragCoord.xy) & 3, 0).xy, 0);
+	vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
+	vec3 bitangent = cross(normal, tangent);
+	mat3 TBN = mat3(tangent, bitangent, normal);
+
+	float bias = 0.05 * radius;
+	float occluded = 0;
+	for(int i = 0; i < kernelSize; ++i)
+	{
+		vec3 s = fragPos + radius * (TBN * samples[i]);
+
+		//the depth of the visible surface where the sample projects to
+		vec4 offset = proj * vec4(s, 1);
+		vec2 uv = offset.xy / offset.w * 0.5 + 0.5;
+		ivec2 sampleTexel = clamp(ivec2(uv * vec2(size)), ivec2(0), size - 1);
+		float sampleDepth = texelFetch(gDepth, sampleTexel, 0).r;
+		float surfaceZ = ViewPosition(sampleTexel, sampleDepth).z;
+
+		//surfaces far in front of the fragment do not occlude it
+		float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - surfaceZ));
+		occluded += (surfaceZ >= s.z + bias ? 1.0 : 0.0) * rangeCheck;
+	}
+	occlusion = 1 - occluded / kernelSize;
+}
@@ -1,10 +0,0 @@
-#version 330
-
-in vec2 texCoords;
-
-out vec2 TexCoords;
-
-void main()
-{
-	TexCoords = texCoords;
-}
\ No newline at end of file
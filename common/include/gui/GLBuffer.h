@@ -20,6 +20,8 @@ namespace nse {
 		{
 			VertexBuffer,
 			IndexBuffer,
+			//storage of a buffer texture (GL_TEXTURE_BUFFER)
+			TextureBuffer,
 		};
 
 		//Represents a generic OpenGL buffer
@@ -77,19 +79,35 @@ namespace nse {
 			//Binds the vertex buffer to the provided attribute of the currently bound GLShader program.
 			void bindToAttribute(const std::string& attribute);
 
+			/// Return the OpenGL name of the buffer, 0 if it has not been generated yet
+			GLuint bufferId() const
+			{
+				return id;
+			}
+
 			/// Return the size of this buffer in bytes
 			size_t bufferSize() const
 			{
-				return size;
+				//untyped uploads store the size in bytes
+				return compSize == (GLuint)-1 ? size : (size_t)size * compSize;
 			}
 
 			void uploadData(uint32_t size, const void *data);
+			/// Upload count vertex attributes of elementSize bytes each. dim and glType are passed to
+			/// glVertexAttribPointer, which allows packed formats such as GL_INT_2_10_10_10_REV and GL_HALF_FLOAT.
+			/// Integer types are converted to [0, 1] or [-1, 1] in the shader if normalized is set.
+			GLBuffer& uploadAttributes(uint32_t count, uint32_t elementSize, int dim, GLuint glType, bool normalized,
+				const void *data);
 			void uploadData(uint32_t size, int dim,
 				uint32_t compSize, GLuint glType, bool integral,
 				const uint8_t *data);
 			void downloadData(uint32_t size, int dim,
 				uint32_t compSize, GLuint glType, uint8_t *data);
 
+			/// Overwrite a part of the buffer with glBufferSubData, the buffer keeps its size and storage.
+			/// offset and bytes are in bytes, the range must lie within the previously uploaded data.
+			void updateData(size_t offset, size_t bytes, const void *data);
+
 
 		protected:
 			GLBufferType type;
@@ -100,6 +118,7 @@ namespace nse {
 			GLuint compSize;
 			GLuint size;
 			bool integral;
+			bool normalized;
 		};
 	}
 }
\ No newline at end of file
@@ -16,7 +16,9 @@ public:
 	void CompileShaders();
 
 	nse::gui::GLShader meshShader;
-    nse::gui::GLShader ssaoShader;
-    nse::gui::GLShader geometryShader;
+	//passes of the deferred path of MeshRenderer
+	nse::gui::GLShader geometryShader;
+	nse::gui::GLShader ssaoShader;
+	nse::gui::GLShader lightingShader;
 	nse::gui::GLShader simpleShader;
 };
\ No newline at end of file
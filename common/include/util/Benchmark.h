@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "util/Parallel.h"
+
+namespace nse
+{
+	namespace util
+	{
+		// Returns the milliseconds that passed since start
+		double MillisecondsSince(const std::chrono::high_resolution_clock::time_point& start);
+
+		// Returns the thread counts for scaling measurements: powers of two up to 32 and the hardware concurrency
+		std::vector<unsigned int> ScalingThreadCounts();
+
+		// Prints "FAILED: description" to std::cerr if passed is false and returns passed
+		bool CheckResult(bool passed, const std::string& description);
+
+		// Returns true if the relative difference of value and reference is at most tolerance
+		bool RelativelyClose(double value, double reference, double tolerance);
+
+		// Returns the path of a file with the given name in the temporary directory of the system. The name is prefixed
+		// with the process id, such that concurrent benchmark runs do not share files.
+		std::string TemporaryFilePath(const std::string& name);
+
+		namespace detail
+		{
+			// Times a run function that returns void
+			template <typename RunFunc>
+			double TimeRun(RunFunc& run, std::true_type)
+			{
+				auto timeStart = std::chrono::high_resolution_clock::now();
+				run();
+				return MillisecondsSince(timeStart);
+			}
+
+			// Uses the time in milliseconds that a run function measured itself
+			template <typename RunFunc>
+			double TimeRun(RunFunc& run, std::false_type)
+			{
+				return run();
+			}
+		}
+
+		// Measures the thread scaling of a parallel computation. For every thread count of ScalingThreadCounts(),
+		// the thread pool is resized, run() is timed and check(threads) validates the result of that run. If run() returns
+		// a double, it is used as the time in milliseconds instead, e.g. to exclude the preparation of the input.
+		// Prints one line per thread count with the time and the speedup over baselineTime (over the run with one
+		// thread if baselineTime is 0) and, if items is not 0, the throughput in million items per second.
+		// Restores the previous number of threads. Returns false if a check failed.
+		template <typename RunFunc, typename CheckFunc>
+		bool MeasureThreadScaling(const std::string& name, RunFunc&& run, CheckFunc&& check, double baselineTime = 0,
+			double items = 0, const char* itemName = "items")
+		{
+			auto& pool = ThreadPool::Instance();
+			unsigned int previousThreads = pool.NumThreads();
+			bool passed = true;
+			for (auto threads : ScalingThreadCounts())
+			{
+				pool.SetNumThreads(threads);
+				double time = detail::TimeRun(run, std::is_void<decltype(run())>());
+				if (baselineTime == 0)
+					baselineTime = time;
+
+				std::cout << name << ", " << threads << " threads: " << time << " ms, speedup " << baselineTime / time;
+				if (items != 0)
+					std::cout << ", " << items / time * 1e-3 << " million " << itemName << "/s";
+				std::cout << std::endl;
+				passed = CheckResult(check(threads), name + " with " + std::to_string(threads) + " threads") && passed;
+			}
+			pool.SetNumThreads(previousThreads);
+			return passed;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace nse
+{
+	namespace util
+	{
+		// Union-find data structure (disjoint sets) that supports concurrent merges and lookups from
+		// multiple threads without locks. Roots are always linked below the smaller index, so the
+		// representative of a set is its smallest entry, independent of the order of the merges.
+		class ConcurrentUnionFind
+		{
+		public:
+			typedef unsigned int index_t;
+
+			// Resets the structure to count singleton sets. Not thread-safe.
+			void Reset(std::size_t count);
+
+			// Returns the number of entries
+			std::size_t size() const { return parentIndices.size(); }
+
+			// Finds the set representative (the smallest entry of the set) of a given entry.
+			// Uses path halving. Thread-safe.
+			index_t GetRepresentative(index_t index);
+
+			// Merges the sets of the two specified entries and returns the new representative. Thread-safe.
+			index_t Merge(index_t i1, index_t i2);
+
+		private:
+			std::vector<std::atomic<index_t>> parentIndices;
+		};
+	}
+}
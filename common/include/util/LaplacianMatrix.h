@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+#include "util/OpenMeshUtils.h"
+
+//edge weights of the discrete Laplace operator
+enum class LaplacianWeights
+{
+	//w_ij = 1
+	Uniform,
+	//w_ij = |p_i - p_j|
+	EdgeLength,
+	//w_ij = 1 / |p_i - p_j|
+	InverseEdgeLength,
+	//w_ij = cot(alpha_ij) + cot(beta_ij) of the corners opposite to the edge, boundary edges only have one
+	Cotangent
+};
+
+//returns the cotangent of the angle between a and b, 0 for degenerate angles
+double Cotangent(const Eigen::Vector3d& a, const Eigen::Vector3d& b);
+
+//returns the weight w_ij of the edge of halfedge h, where i is the origin and j the target of h
+double LaplacianWeight(const HEMesh& m, OpenMesh::HalfedgeHandle h, LaplacianWeights type);
+
+//Sparse Laplace matrix with L_ij = w_ij for adjacent vertices and L_ii = -sum_j w_ij.
+//The sparsity pattern is computed once per connectivity, the values are written directly to the
+//compressed storage when the geometry changes. The matrix is symmetric, so its compressed column
+//storage is also the compressed row storage.
+//Cotangent weights are cached per face together with the vertex positions they belong to, so an
+//update only recomputes the corners of faces with a moved vertex.
+class LaplacianMatrix
+{
+public:
+	//computes the sparsity pattern for the connectivity of m, all values are zero
+	void BuildPattern(const HEMesh& m);
+
+	//returns true if the pattern was built for a mesh with the element counts of m
+	bool MatchesConnectivity(const HEMesh& m) const;
+
+	//discards the pattern, must be called if the connectivity changes without changing the element counts
+	void Clear();
+
+	//updates the values to the current vertex positions of m in parallel and returns the number of faces whose
+	//corners were recomputed. Cotangent weights are only recomputed for faces with a moved vertex, all other weight
+	//types and a change of the type recompute all faces. Builds the pattern first if necessary.
+	size_t UpdateWeights(const HEMesh& m, LaplacianWeights type);
+
+	//returns the Laplace matrix
+	const Eigen::SparseMatrix<double>& Matrix() const { return matrix; }
+
+	//returns the weight w_ij of every edge, indexed by edge index
+	const std::vector<double>& EdgeWeights() const { return edgeWeights; }
+
+	//returns the index of the entry of halfedge h (from i to j) in the value array of column i
+	int HalfedgeEntry(OpenMesh::HalfedgeHandle h) const { return halfedgeEntry[h.idx()]; }
+
+	//returns the index of the diagonal entry of vertex v in the value array
+	int DiagonalEntry(OpenMesh::VertexHandle v) const { return diagonalEntry[v.idx()]; }
+
+private:
+	//recomputes the halfedge cotangents of the faces with a moved vertex and the edge weights, returns the number of
+	//recomputed faces
+	size_t UpdateCotangents(const HEMesh& m);
+
+	Eigen::SparseMatrix<double> matrix;
+	std::vector<int> halfedgeEntry, diagonalEntry;
+	std::vector<double> edgeWeights;
+	size_t numFaces = 0;
+
+	//weight type of the current values
+	LaplacianWeights weights = LaplacianWeights::Uniform;
+	//vertex positions that the cotangents were computed for, empty if the values are not cotangent weights
+	std::vector<OpenMesh::Vec3f> positions;
+	//cotangent of the corner opposite to each halfedge in its face, 0 for boundary halfedges
+	std::vector<double> halfedgeCotangents;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Core>
+
+#include "util/OpenMeshUtils.h"
+
+//Snapshot of the vertex connectivity of a mesh in compressed sparse row format.
+//The neighbors of vertex i are neighbors[offsets[i]] ... neighbors[offsets[i + 1] - 1] in the order of the
+//vertex-vertex circulator. Kernels that iterate over the mesh many times can use the flat arrays
+//instead of following halfedge pointers.
+struct MeshAdjacency
+{
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> neighbors;
+	//1 for boundary vertices, 0 otherwise
+	std::vector<unsigned char> boundary;
+
+	//returns the number of vertices
+	std::size_t NumVertices() const { return boundary.size(); }
+
+	//returns the number of neighbors of vertex i
+	unsigned int Valence(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+//Partition of the vertices into independent sets, no two adjacent vertices have the same color.
+//The vertices of color c are vertices[offsets[c]] ... vertices[offsets[c + 1] - 1] in ascending order.
+struct VertexColoring
+{
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> vertices;
+
+	//returns the number of colors
+	std::size_t NumColors() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+//builds the adjacency snapshot of all vertices of m
+void BuildMeshAdjacency(const HEMesh& m, MeshAdjacency& adjacency);
+
+//copies the vertex positions of m to a flat array
+void GetVertexPositions(const HEMesh& m, std::vector<Eigen::Vector3f>& positions);
+
+//copies the positions from a flat array back to the vertices of m
+void SetVertexPositions(HEMesh& m, const std::vector<Eigen::Vector3f>& positions);
+
+//greedily colors the vertices in index order. The result only depends on the connectivity and uses
+//at most (maximum valence + 1) colors.
+void ColorVertices(const MeshAdjacency& adjacency, VertexColoring& coloring);
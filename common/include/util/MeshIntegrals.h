@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "util/OpenMeshUtils.h"
+
+//integral properties of a closed mesh with unit density
+struct MeshIntegrals
+{
+	//surface area of all faces
+	double area = 0;
+	//signed volume enclosed by the faces (positive for outward oriented faces)
+	double volume = 0;
+	//center of mass of the enclosed solid
+	Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+	//inertia tensor of the enclosed solid with respect to its centroid
+	Eigen::Matrix3d inertia = Eigen::Matrix3d::Zero();
+};
+
+//computes area, volume, centroid and inertia tensor of the mesh in a single parallel pass over its faces.
+//Polygons are split into triangle fans. The volume integrals follow D. Eberly, "Polyhedral Mass Properties".
+//Each block of faces is summed with compensated (Neumaier) summation in double precision and the block sums
+//are combined in a fixed order, such that the result does not depend on the number of threads.
+//The volume, centroid and inertia tensor are only meaningful for closed meshes.
+MeshIntegrals ComputeMeshIntegrals(const HEMesh& m);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Core>
+
+#include "util/OpenMeshUtils.h"
+
+//computes for every face the sum of the cross products of its fan triangles, which is the face normal scaled by
+//twice the face area. Runs in parallel over the faces.
+void ComputeFaceNormals(const HEMesh& m, std::vector<Eigen::Vector3f>& faceNormals);
+
+//computes the area weighted vertex normals from faceNormals (see ComputeFaceNormals). Every vertex sums the
+//vectors of its incident faces in circulator order, which gives the same result for any number of threads.
+//The normals are not normalized, for triangle meshes they equal the result of calc_vertex_normal_correct.
+void ComputeVertexNormals(const HEMesh& m, const std::vector<Eigen::Vector3f>& faceNormals, std::vector<Eigen::Vector3f>& vertexNormals);
+
+//computes the face normals and the area weighted vertex normals of m
+void ComputeVertexNormals(const HEMesh& m, std::vector<Eigen::Vector3f>& vertexNormals);
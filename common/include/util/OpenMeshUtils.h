@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
 #include <Eigen/Core>
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 
@@ -7,6 +9,8 @@
 #include <gui/GLVertexArray.h>
 #include <gui/GLShader.h>
 
+#include "util/VertexCache.h"
+
 typedef OpenMesh::PolyMesh_ArrayKernelT<>  HEMesh;
 
 //Converts an OpenMesh vector to an Eigen vector 
@@ -39,40 +43,239 @@ static Eigen::Vector4f ToEigenVector4(const OpenMesh::Vec2f& v, float z = 0, flo
 	return Eigen::Vector4f(v[0], v[1], z, w);
 }
 
+//Writes the corners of all faces to indices as a triangle list, polygons are split into triangle fans.
+//If triangleFaces is given, it receives the face index of every triangle.
+void GetTriangleIndices(const HEMesh& mesh, std::vector<uint32_t>& indices, std::vector<uint32_t>* triangleFaces = nullptr);
+
+//Order of the triangles in the triangle list of a MeshRenderer
+enum class TriangleOrder
+{
+	//the order of the faces in the mesh
+	Original,
+	//reordered with OptimizeVertexCache
+	VertexCache,
+	//reordered with OptimizeVertexCache and OptimizeOverdraw
+	VertexCacheAndOverdraw
+};
+
+//Layout of the vertex attributes of a MeshRenderer
+enum class VertexFormat
+{
+	//4 floats per position and normal and 2 floats per texture coordinate (40 bytes per vertex with all attributes)
+	Float,
+	//3 floats per position, normals as GL_INT_2_10_10_10_REV and texture coordinates as half floats (20 bytes per vertex)
+	Packed,
+	//like Packed with positions quantized to 16 bits per coordinate relative to the bounding box (16 bytes per vertex)
+	Quantized
+};
+
+//How MeshRenderer::Render shades the mesh
+enum class RenderPath
+{
+	//a single pass with the mesh shader
+	Forward,
+	//one geometry pass into a G-buffer, screen space ambient occlusion in half resolution and a full-screen lighting
+	//pass that upsamples the occlusion with a bilateral filter
+	Deferred
+};
+
+//GPU times of the passes of MeshRenderer::Render in milliseconds, passes that did not run are 0
+struct RenderPassTimes
+{
+	//the pass that draws the mesh, i.e. the mesh shader pass of the forward path or the G-buffer pass
+	double geometry = 0;
+	double ssao = 0;
+	double lighting = 0;
+};
+
+//index that separates two strips in a strip index buffer
+const uint32_t StripRestartIndex = 0xffffffff;
+
+//Summary of a strip index buffer built by BuildTriangleStripIndices
+struct TriangleStripStatistics
+{
+	size_t strips = 0;
+	size_t triangles = 0;
+	//number of places where a strip continues across the edge that does not alternate, each costs two indices
+	size_t swaps = 0;
+	//number of indices including the restart indices
+	size_t stripIndices = 0;
+	//number of indices of the same triangles drawn as a triangle list
+	size_t triangleListIndices = 0;
+};
+
+//Builds the indices for drawing the mesh as GL_TRIANGLE_STRIP with primitive restart. The triangles with the same
+//id in stripIdProperty are connected to strips along shared edges, a strip is split where its faces do not form a
+//single path. Faces with negative ids and faces with more than three vertices form strips of their own.
+//The triangles keep the orientation of the faces.
+TriangleStripStatistics BuildTriangleStripIndices(const HEMesh& mesh, OpenMesh::FPropHandleT<int> stripIdProperty, std::vector<uint32_t>& indices);
+
 //GPU representation of a mesh with rendering capabilities.
 class MeshRenderer
 {
 public:
 	MeshRenderer(const HEMesh& mesh);
+	~MeshRenderer();
 
-	//Update the underlying buffers based on the current geometry in the referenced mesh
+	//Update the underlying buffers based on the current geometry in the referenced mesh.
+	//Only the ranges of the vertex attributes that changed since the last update are uploaded and the index
+	//buffer is kept if the connectivity did not change (see ConnectivityChanged).
 	void Update();
 
-    GLuint gBuffer;
-    GLuint gPosition, gNormal, gAlbedo;
+	//Must be called after edits that change the faces of the mesh but not the number of vertices and faces, e.g.
+	//loading another mesh of the same size. The next update rebuilds the triangle list. Changes of the element
+	//counts are detected by the update itself.
+	void ConnectivityChanged() { ++connectivityRevision; }
+
+	//Update the vertex attributes after edits that moved vertices but kept the connectivity and the texture
+	//coordinates, e.g. smoothing. Keeps the current mode (triangle list, strips or per-face colors) and does
+	//not rebuild any index data.
+	void UpdateGeometry();
+
+	//drops the copies of the uploaded data, the next update uploads all buffers completely
+	void InvalidateBuffers();
+
+	//returns the number of bytes that the last update uploaded to the GPU
+	size_t UploadedBytes() const { return uploadedBytes; }
 
-    //float MeshRenderer::lerp(float a, float b, float f);
+	//Sets the layout of the vertex attributes, the default is VertexFormat::Float. Takes effect at the next update.
+	void SetVertexFormat(VertexFormat format);
+
+	//returns the size of all buffers of the mesh in GPU memory
+	size_t GPUMemoryBytes() const;
+
+	//Update like Update and color the faces with colorProperty. The colors are stored per drawn triangle in a buffer
+	//texture, which the fragment shader reads with gl_PrimitiveID, so the vertices stay shared between faces.
 	void UpdateWithPerFaceColor(OpenMesh::FPropHandleT<Eigen::Vector4f> colorProperty);
-    //void MeshRenderer::UpdateSSAOBuffers();
-    std::vector<Eigen::Vector3f> ssaoKernel;
-    GLuint noiseTexture;
 
-    void Render(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading = false, bool withTexCoords = false, const Eigen::Vector4f& color = Eigen::Vector4f(0.8f, 0.7f, 0.6f, 1.0f)) const;
-	void RenderGBuffer(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading = false, bool withTexCoords = false, const Eigen::Vector4f& color = Eigen::Vector4f(0.8f, 0.7f, 0.6f, 1.0f)) const;
-	void RenderSSAO(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading = false, bool withTexCoords = false, const Eigen::Vector4f& color = Eigen::Vector4f(0.8f, 0.7f, 0.6f, 1.0f)) const;
+	//Update the underlying buffers and draw the mesh as triangle strips, which are built from the strip ids
+	//of the faces. Per-face colors are not supported in this mode.
+	TriangleStripStatistics UpdateWithTriangleStrips(OpenMesh::FPropHandleT<int> stripIdProperty);
+
+	//Sets the order of the triangles for the next Update, the default is TriangleOrder::Original.
+	//The order is only recomputed when the connectivity changes, not when the vertices move.
+	void SetTriangleOrder(TriangleOrder order);
+
+	//returns the vertex cache efficiency of the triangle list of the last Update in mesh order and in the drawn order
+	const VertexCacheStatistics& OriginalCacheStatistics() const { return originalCacheStatistics; }
+	const VertexCacheStatistics& CacheStatistics() const { return cacheStatistics; }
+
+	//renders the mesh with a pipeline statistics query and returns the number of vertex shader invocations,
+	//0 if GL_ARB_pipeline_statistics_query is not supported
+	GLuint64 CountVertexShaderInvocations(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection) const;
+
+	//Sets how Render shades the mesh, the default is RenderPath::Forward. The deferred path renders into targets of
+	//the size of the current viewport and writes the depth of the mesh, so it composes with other draw calls.
+	void SetRenderPath(RenderPath path) { renderPath = path; }
+
+	//Starts a new frame for the pass timers, call it once per frame before the Render calls of the frame. Only the
+	//first Render calls of a frame are timed if it is never called.
+	void BeginFrame();
+
+	//Returns the GPU times of the passes of a recent frame, summed over its Render calls. The timer queries are read
+	//back a few frames later so they never stall the pipeline.
+	const RenderPassTimes& PassTimes() const { return passTimes; }
+
+	void Render(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading = false, bool withTexCoords = false, const Eigen::Vector4f& color = Eigen::Vector4f(0.8f, 0.7f, 0.6f, 1.0f)) const;
 	void RenderTextureMap(const Eigen::Matrix4f& projection, const Eigen::Vector4f& color) const;
 
 private:	
 
+	//uploads the changed texture coordinates of the texture map and rebuilds its edge indices if the connectivity changed
 	void UpdateTextureMapBuffers();
+	void UploadVertexBuffers();
+	//uploads the colors of the faces of the drawn triangles to the face color buffer texture
+	void UploadFaceColors();
+	//converts the attributes to the vertex format and uploads the changed ranges, uvs may be empty
+	void UploadAttributes(const std::vector<Eigen::Vector3f>& positions, const std::vector<Eigen::Vector3f>& normals,
+		const std::vector<Eigen::Vector2f>& uvs);
+	//sets the uniforms that map the position attribute to model space
+	void SetPositionDecoding(nse::gui::GLShader& shader) const;
+	//binds the face color buffer texture if the faces are colored and sets the uniforms that select it
+	void SetFaceColors(nse::gui::GLShader& shader) const;
+	//binds shader and sets the uniforms of the mesh shader and the G-buffer shader
+	void SetMaterialUniforms(nse::gui::GLShader& shader, const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection,
+		bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const;
+
+	void RenderForward(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const;
+	void RenderDeferred(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const;
+	//creates the render targets of the deferred path or resizes them to the viewport, returns false if the
+	//framebuffers are incomplete
+	bool PrepareDeferredTargets(int width, int height) const;
+	//draws a triangle that covers the viewport
+	void DrawFullScreenTriangle() const;
+
+	//timer queries of the passes of the current Render call, a query is used again timerQueryFrames frames later
+	void BeginPassTimer(int pass) const;
+	void EndPassTimer() const;
+	//adds up the results of the queries of the current frame in passTimes if they are all available
+	void ReadPassTimes();
+
+	//issues the draw call for the current primitive type
+	void Draw() const;
 
 	const HEMesh& mesh;
 
-	nse::gui::GLBuffer positionBuffer, normalBuffer, colorBuffer, texCoordBuffer, texCoordBuffer4D;
+	nse::gui::GLBuffer positionBuffer, normalBuffer, texCoordBuffer, texCoordBuffer4D;
 	nse::gui::GLBuffer indexBuffer, indexBufferTexCoords;
 	unsigned int indexCount;
 	unsigned int indexCountTexCoords;
 	nse::gui::GLVertexArray vao, vaoTexCoords;
 
 	bool hasColor = false;
+	OpenMesh::FPropHandleT<Eigen::Vector4f> faceColorProperty;
+	//RGBA8 color of every drawn triangle, read as a GL_TEXTURE_BUFFER
+	nse::gui::GLBuffer faceColorBuffer;
+	GLuint faceColorTexture = 0;
+	//GL_TRIANGLES or GL_TRIANGLE_STRIP
+	GLenum primitiveType = GL_TRIANGLES;
+
+	TriangleOrder triangleOrder = TriangleOrder::Original;
+	//triangle list in mesh order and in the drawn order, both are reused while the connectivity does not change
+	std::vector<uint32_t> meshOrderIndices, orderedIndices;
+	//incremented by ConnectivityChanged
+	size_t connectivityRevision = 0;
+	//revision and element counts of the mesh that the triangle lists were built for
+	size_t indexedRevision = 0, indexedVertices = 0, indexedFaces = 0;
+	//face index of every triangle in orderedIndices
+	std::vector<uint32_t> orderedTriangleFaces;
+	VertexCacheStatistics originalCacheStatistics, cacheStatistics;
+
+	VertexFormat vertexFormat = VertexFormat::Float;
+	//model space position = positionOffset + positionScale * position attribute
+	Eigen::Vector3f positionOffset = Eigen::Vector3f::Zero(), positionScale = Eigen::Vector3f::Ones();
+
+	//copies of the data in the vertex buffers, updates compare against them to find the changed ranges
+	std::vector<uint8_t> uploadedPositions, uploadedNormals, uploadedTexCoords, uploadedTexCoords4D;
+	//true if the index buffer contains orderedIndices
+	bool indexBufferHoldsTriangleList = false;
+	//true if indexBufferTexCoords contains the edges of the mesh with the revision and element counts below
+	bool texCoordIndicesUploaded = false;
+	size_t texCoordIndexedRevision = 0, texCoordIndexedVertices = 0, texCoordIndexedEdges = 0;
+	size_t uploadedBytes = 0;
+
+	RenderPath renderPath = RenderPath::Forward;
+	//the render targets are created and resized by Render
+	//the G-buffer holds depth, view space normals and albedo in the size of the viewport
+	mutable GLuint gBuffer = 0, gDepth = 0, gNormal = 0, gAlbedo = 0;
+	//ambient occlusion in half the size of the G-buffer
+	mutable GLuint ssaoBuffer = 0, ssaoTexture = 0;
+	mutable int targetWidth = 0, targetHeight = 0;
+	mutable std::vector<Eigen::Vector3f> ssaoKernel;
+	mutable GLuint noiseTexture = 0;
+	//radius of the SSAO hemisphere, proportional to the size of the mesh
+	float ssaoRadius = 1;
+	//the full-screen passes have no vertex attributes but need a bound vertex array in the core profile
+	nse::gui::GLVertexArray emptyVao;
+
+	static const int timerQueryFrames = 3;
+	//Render calls per frame that are timed, exercise 5 draws the mesh twice per frame
+	static const int timedRenderCalls = 4;
+	static const int timedPasses = 3;
+	GLuint timerQueries[timerQueryFrames][timedRenderCalls][timedPasses];
+	mutable bool timerQueryUsed[timerQueryFrames][timedRenderCalls][timedPasses] = {};
+	int timerQueryFrame = 0;
+	//number of Render calls since BeginFrame
+	mutable int frameRenderCalls = 0;
+	RenderPassTimes passTimes;
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nse
+{
+	namespace util
+	{
+		// A fixed set of worker threads that executes batches of independent tasks.
+		// The calling thread participates in the execution of each batch.
+		class ThreadPool
+		{
+		public:
+			typedef std::function<void(std::size_t task, unsigned int thread)> TaskFunction;
+
+			// Returns the process-wide pool
+			static ThreadPool& Instance();
+
+			~ThreadPool();
+
+			// Returns the number of threads that execute a batch (including the calling thread)
+			unsigned int NumThreads() const;
+
+			// Sets the number of threads that execute a batch. 0 selects the hardware concurrency.
+			void SetNumThreads(unsigned int count);
+
+			// Calls task(i, thread) for every i in [0, taskCount) and blocks until all tasks are done.
+			// thread is in [0, NumThreads()) and identifies the executing thread, e.g. to select scratch memory.
+			// Batches started from within a task are executed serially by the calling thread.
+			void Run(std::size_t taskCount, const TaskFunction& task);
+
+		private:
+			ThreadPool();
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			void StartWorkers(unsigned int count);
+			void StopWorkers();
+			// lastBatch is the batch that was current when the worker was started, the worker only joins later ones
+			void WorkerLoop(unsigned int thread, unsigned long long lastBatch);
+			// executes tasks of the batch with the given task and count until nextTask passes the count
+			void ExecuteTasks(unsigned int thread, const TaskFunction& task, std::size_t count);
+
+			std::vector<std::thread> workers;
+
+			// serializes batches that are started concurrently from different threads
+			std::mutex runMutex;
+
+			std::mutex stateMutex;
+			std::condition_variable batchStarted, batchFinished;
+			const TaskFunction* currentTask;
+			std::size_t taskCount;
+			std::atomic<std::size_t> nextTask;
+			unsigned int busyWorkers;
+			unsigned long long batchId;
+			bool stopping;
+		};
+
+		// Returns the number of threads that ParallelFor and ParallelForChunks use
+		inline unsigned int NumThreads() { return ThreadPool::Instance().NumThreads(); }
+
+		// Calls f(chunk, chunkBegin, chunkEnd, thread) for consecutive ranges of at most chunkSize
+		// indices that cover [begin, end). Chunk boundaries only depend on chunkSize, which makes
+		// per-chunk partial results (e.g. sums) reproducible for any thread count.
+		template <typename Func>
+		void ParallelForChunks(std::size_t begin, std::size_t end, std::size_t chunkSize, Func&& f)
+		{
+			if (end <= begin)
+				return;
+			chunkSize = std::max<std::size_t>(chunkSize, 1);
+			std::size_t chunks = (end - begin + chunkSize - 1) / chunkSize;
+			ThreadPool::Instance().Run(chunks, [&](std::size_t chunk, unsigned int thread)
+			{
+				std::size_t chunkBegin = begin + chunk * chunkSize;
+				std::size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+				f(chunk, chunkBegin, chunkEnd, thread);
+			});
+		}
+
+		// Calls f(i) for every i in [begin, end) in parallel.
+		template <typename Func>
+		void ParallelFor(std::size_t begin, std::size_t end, Func&& f)
+		{
+			if (end <= begin)
+				return;
+			//a few chunks per thread for load balancing
+			std::size_t chunkSize = std::max<std::size_t>(256, (end - begin) / (8 * NumThreads()) + 1);
+			ParallelForChunks(begin, end, chunkSize, [&](std::size_t, std::size_t chunkBegin, std::size_t chunkEnd, unsigned int)
+			{
+				for (std::size_t i = chunkBegin; i < chunkEnd; ++i)
+					f(i);
+			});
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+
+#include "util/OpenMeshUtils.h"
+
+//Space-filling curves through a cubic grid of 2^21 cells per axis
+enum class SpaceFillingCurve
+{
+	//interleaves the bits of the cell coordinates (Z-order), cheap but with jumps between octants
+	Morton,
+	//Hilbert curve after J. Skilling, "Programming the Hilbert curve", consecutive cells are always adjacent
+	Hilbert
+};
+
+//computes the position along the curve of every point, the grid spans the bounding box of all points
+void ComputeCurveKeys(const std::vector<Eigen::Vector3f>& points, SpaceFillingCurve curve, std::vector<uint64_t>& keys);
+
+//Moves vertex i to index newVertexIndex[i] and face i to newFaceIndex[i]. The arrays must be permutations. The mesh
+//is rebuilt with add_vertex and add_face, so the edges are created in the order in which the reordered faces reach
+//them. Points and texture coordinates are carried over. Other properties stay registered and their handles stay valid,
+//but their values are reset and have to be recomputed by the caller (e.g. with update_normals()). Element handles held
+//by the caller refer to other elements afterwards. The mesh must not contain deleted elements.
+//Returns false if add_face rejects a face in the new order (e.g. a non-manifold configuration), the mesh then lacks
+//this face and the following faces have lower indices than requested.
+bool PermuteMesh(HEMesh& m, const std::vector<unsigned int>& newVertexIndex, const std::vector<unsigned int>& newFaceIndex);
+
+//Sorts the vertices by the curve key of their position and the faces by the curve key of their centroid. The edges
+//follow the faces that contain them. Neighboring elements then mostly have close indices, which makes loops over the
+//mesh access memory more coherently. Returns false if PermuteMesh failed.
+bool ReorderMeshAlongCurve(HEMesh& m, SpaceFillingCurve curve);
+
+//moves the vertices and faces of m to random positions (the edges follow the faces), this gives a reference order
+//without any locality, returns false if PermuteMesh failed
+bool ShuffleMesh(HEMesh& m, unsigned int seed);
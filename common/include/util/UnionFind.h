@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 
 namespace nse
 {
@@ -15,13 +16,29 @@ namespace nse
 		public:
 			typedef unsigned int index_t;
 
-			// Saves the entire structure to a file for later usage
+			// Strategy that decides which root becomes the new root when two sets are merged
+			enum class MergePolicy
+			{
+				// The root of the tree with higher rank (upper bound of the height) becomes the new root
+				ByRank,
+				// The root of the set with more entries becomes the new root
+				BySize
+			};
+
+			UnionFind(MergePolicy policy = MergePolicy::ByRank);
+
+			// Returns the merge policy
+			MergePolicy Policy() const { return policy; }
+
+			// Saves the entire structure to a file for later usage. The parents are stored with fully compressed
+			// paths, such that the file can also be used by MappedUnionFind. Throws std::runtime_error on failure.
 			void SaveToFile(const char* filename) const;
 
 			// Returns the number of entries
 			std::size_t size() const;
 
 			// Loads the entire structure from a file. Existing data in the structure is overridden.
+			// Also reads files of the previous format without header. Throws std::runtime_error on failure.
 			void LoadFromFile(const char* filename);
 
 			// Adds an item to the structure
@@ -45,8 +62,48 @@ namespace nse
 		private:
 			void ConcreteMerge(index_t newRoot, index_t child);
 
+			MergePolicy policy;
 			std::vector<index_t> parentIndices;
+			// rank or number of entries of the set of every root, depending on the merge policy
 			std::vector<unsigned int> ranks;
 		};
+
+		// Read-only view of a union-find structure that was saved with UnionFind::SaveToFile.
+		// The file is memory-mapped, so opening it takes constant time and the operating system only
+		// loads the pages that are accessed. Lookups do not modify the structure and are thread-safe.
+		class MappedUnionFind
+		{
+		public:
+			typedef UnionFind::index_t index_t;
+
+			MappedUnionFind();
+			~MappedUnionFind();
+			MappedUnionFind(const MappedUnionFind&) = delete;
+			MappedUnionFind& operator=(const MappedUnionFind&) = delete;
+
+			// Maps the file. Throws std::runtime_error if it cannot be mapped or is not a union-find file.
+			void Open(const char* filename);
+
+			// Unmaps the file
+			void Close();
+
+			bool IsOpen() const { return mapping != nullptr; }
+
+			// Returns the number of entries
+			std::size_t size() const { return (std::size_t)entries; }
+
+			// Returns the set representative for a given entry
+			index_t GetRepresentative(index_t index) const { return parentIndices[index]; }
+
+		private:
+			const void* mapping;
+			std::size_t mappingSize;
+			std::uint64_t entries;
+			const index_t* parentIndices;
+#ifdef _WIN32
+			void* fileHandle;
+			void* mappingHandle;
+#endif
+		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+
+//Efficiency of a triangle index buffer for a simulated FIFO post-transform vertex cache
+struct VertexCacheStatistics
+{
+	//average cache miss ratio, the number of transformed vertices per triangle (0.5 is optimal for large meshes, 3 is the worst case)
+	double acmr = 0;
+	//average transformed vertex ratio, the number of transformed vertices per referenced vertex (1 is optimal)
+	double atvr = 0;
+};
+
+//Simulates a FIFO vertex cache with cacheSize entries for the triangle list indices
+VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+//Reorders the triangles of the triangle list indices for a better use of the post-transform vertex cache with the
+//greedy algorithm of T. Forsyth, "Linear-Speed Vertex Cache Optimisation". Each step emits the triangle with the
+//highest score, the score of a vertex prefers vertices that are recently used in a simulated LRU cache of 32 entries
+//and vertices with few remaining triangles. The corners of each triangle keep their order.
+//If triangleData is given, it holds one entry per triangle and is reordered together with the triangles.
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>* triangleData = nullptr);
+
+//Reorders clusters of a cache optimized triangle list such that outward facing parts are drawn first, which
+//reduces overdraw, following Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+//Clusters end where the simulated cache restarts and additionally where the cache miss ratio of the cluster drops
+//below threshold times the ratio of the whole run, a larger threshold gives more and smaller clusters.
+//If triangleData is given, it holds one entry per triangle and is reordered together with the triangles.
+//Returns the number of clusters.
+size_t OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Eigen::Vector3f>& positions, float threshold = 1.05f,
+	std::vector<uint32_t>* triangleData = nullptr);
@@ -16,14 +16,15 @@ using namespace nse::gui;
 const GLuint BufferTargets[] = 
 {
 	GL_ARRAY_BUFFER, 
-	GL_ELEMENT_ARRAY_BUFFER
+	GL_ELEMENT_ARRAY_BUFFER,
+	GL_TEXTURE_BUFFER
 #ifdef HAVE_SSBO
 	, GL_SHADER_STORAGE_BUFFER 
 #endif
 };
 
 GLBuffer::GLBuffer(GLBufferType type)
-	: id(0), type(type)
+	: id(0), type(type), glType(0), dim(0), compSize(0), size(0), integral(false), normalized(false)
 {}
 
 GLBuffer::~GLBuffer()
@@ -59,7 +60,7 @@ void GLBuffer::bindToAttribute(const std::string& attribute)
 		if (integral)
 			glVertexAttribIPointer(attribID, dim, glType, 0, 0);
 		else
-			glVertexAttribPointer(attribID, dim, glType, GL_FALSE, 0, 0);
+			glVertexAttribPointer(attribID, dim, glType, normalized ? GL_TRUE : GL_FALSE, 0, 0);
 	}
 	else
 		std::cout << "Warning: Attribute \"" << attribute << "\" not found in shader \"" << prog->name() << "\"." << std::endl;
@@ -74,6 +75,7 @@ void GLBuffer::uploadData(uint32_t size, int dim,
 	this->compSize = compSize;
 	this->size = size;
 	this->integral = integral;
+	this->normalized = false;
 	
 	size_t totalSize = (size_t)size * (size_t)compSize;
 
@@ -90,12 +92,41 @@ void GLBuffer::uploadData(uint32_t size, const void *data)
 	this->compSize = -1;
 	this->size = size;
 	this->integral = false;
+	this->normalized = false;
 
 	bind();
 
 	glBufferData(BufferTargets[type], size, data, GL_DYNAMIC_DRAW);
 }
 
+GLBuffer& GLBuffer::uploadAttributes(uint32_t count, uint32_t elementSize, int dim, GLuint glType, bool normalized,
+	const void *data)
+{
+	//the size is counted in bytes
+	this->glType = glType;
+	this->dim = dim;
+	this->compSize = 1;
+	this->size = count * elementSize;
+	this->integral = false;
+	this->normalized = normalized;
+
+	bind();
+
+	glBufferData(BufferTargets[type], (size_t)count * elementSize, data, GL_DYNAMIC_DRAW);
+
+	return *this;
+}
+
+void GLBuffer::updateData(size_t offset, size_t bytes, const void *data)
+{
+	if (bytes == 0)
+		return;
+
+	bind();
+
+	glBufferSubData(BufferTargets[type], offset, bytes, data);
+}
+
 void GLBuffer::downloadData(uint32_t size, int /* dim */,
 	uint32_t compSize, GLuint /* glType */, uint8_t *data)
 {
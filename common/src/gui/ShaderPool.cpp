@@ -20,7 +20,8 @@ ShaderPool* ShaderPool::Instance()
 void ShaderPool::CompileShaders()
 {
 	meshShader.init("Mesh Shader", std::string((char*)mesh_vert, mesh_vert_size), std::string((char*)mesh_frag, mesh_frag_size));
-    ssaoShader.init("SSAO Shader", std::string((char*)ssao_vert, ssao_vert_size), std::string((char*)ssao_frag, ssao_frag_size));
-    geometryShader.init("Geometry Shader", std::string((char*)geometry_vert, geometry_vert_size), std::string((char*)geometry_frag, geometry_frag_size));
+	geometryShader.init("Geometry Shader", std::string((char*)geometry_vert, geometry_vert_size), std::string((char*)geometry_frag, geometry_frag_size));
+	ssaoShader.init("SSAO Shader", std::string((char*)fullscreen_vert, fullscreen_vert_size), std::string((char*)ssao_frag, ssao_frag_size));
+	lightingShader.init("Lighting Shader", std::string((char*)fullscreen_vert, fullscreen_vert_size), std::string((char*)lighting_frag, lighting_frag_size));
 	simpleShader.init("Simple Shader", std::string((char*)simple_vert, simple_vert_size), std::string((char*)simple_frag, simple_frag_size));
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "util/Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace nse
+{
+	namespace util
+	{
+		double MillisecondsSince(const std::chrono::high_resolution_clock::time_point& start)
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+
+		std::vector<unsigned int> ScalingThreadCounts()
+		{
+			unsigned int maxThreads = std::min(32u, std::max(1u, std::thread::hardware_concurrency()));
+			std::vector<unsigned int> threadCounts;
+			for (unsigned int threads = 1; threads < maxThreads; threads *= 2)
+				threadCounts.push_back(threads);
+			threadCounts.push_back(maxThreads);
+			return threadCounts;
+		}
+
+		bool CheckResult(bool passed, const std::string& description)
+		{
+			if (!passed)
+				std::cerr << "FAILED: " << description << std::endl;
+			return passed;
+		}
+
+		bool RelativelyClose(double value, double reference, double tolerance)
+		{
+			return std::abs(value - reference) <= tolerance * std::max(std::abs(reference), 1e-30);
+		}
+
+		std::string TemporaryFilePath(const std::string& name)
+		{
+#ifdef _WIN32
+			char directory[MAX_PATH + 1];
+			DWORD length = GetTempPathA(sizeof(directory), directory);
+			//GetTempPathA returns the directory with a trailing backslash
+			std::string path = length > 0 && length < sizeof(directory) ? std::string(directory, length) : std::string(".\\");
+			return path + std::to_string(GetCurrentProcessId()) + "_" + name;
+#else
+			const char* directory = std::getenv("TMPDIR");
+			std::string path = directory && *directory ? directory : "/tmp";
+			if (path.back() != '/')
+				path += '/';
+			return path + std::to_string(getpid()) + "_" + name;
+#endif
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#include "util/ConcurrentUnionFind.h"
+
+#include "util/Parallel.h"
+
+using namespace nse::util;
+
+void ConcurrentUnionFind::Reset(std::size_t count)
+{
+	if (parentIndices.size() != count)
+		std::vector<std::atomic<index_t>>(count).swap(parentIndices);
+	ParallelFor(0, count, [this](std::size_t i)
+	{
+		parentIndices[i].store((index_t)i, std::memory_order_relaxed);
+	});
+}
+
+ConcurrentUnionFind::index_t ConcurrentUnionFind::GetRepresentative(index_t index)
+{
+	while (true)
+	{
+		index_t parent = parentIndices[index].load(std::memory_order_relaxed);
+		if (parent == index)
+			return index;
+		index_t grandParent = parentIndices[parent].load(std::memory_order_relaxed);
+		//path halving, the grandparent is still an ancestor if another thread changed the parent meanwhile
+		if (parent != grandParent)
+			parentIndices[index].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+		index = grandParent;
+	}
+}
+
+ConcurrentUnionFind::index_t ConcurrentUnionFind::Merge(index_t i1, index_t i2)
+{
+	while (true)
+	{
+		i1 = GetRepresentative(i1);
+		i2 = GetRepresentative(i2);
+		if (i1 == i2)
+			return i1;
+		if (i1 < i2)
+			std::swap(i1, i2);
+		//link the larger root below the smaller one, this fails if i1 stopped being a root meanwhile
+		index_t expected = i1;
+		if (parentIndices[i1].compare_exchange_strong(expected, i2, std::memory_order_relaxed))
+			return i2;
+	}
+}
@@ -0,0 +1,200 @@
+#include "util/LaplacianMatrix.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "util/Parallel.h"
+
+double Cotangent(const Eigen::Vector3d& a, const Eigen::Vector3d& b)
+{
+	double sine = a.cross(b).norm();
+	if (sine == 0)
+		return 0;
+	return a.dot(b) / sine;
+}
+
+//returns the cotangent of the corner opposite to halfedge h in its face, 0 for boundary halfedges
+static double OppositeCotangent(const HEMesh& m, OpenMesh::HalfedgeHandle h)
+{
+	if (m.is_boundary(h))
+		return 0;
+	Eigen::Vector3d corner = ToEigenVector(m.point(m.to_vertex_handle(m.next_halfedge_handle(h)))).cast<double>();
+	Eigen::Vector3d from = ToEigenVector(m.point(m.from_vertex_handle(h))).cast<double>();
+	Eigen::Vector3d to = ToEigenVector(m.point(m.to_vertex_handle(h))).cast<double>();
+	return Cotangent(from - corner, to - corner);
+}
+
+//returns the length of the edge of halfedge h
+static double EdgeLength(const HEMesh& m, OpenMesh::HalfedgeHandle h)
+{
+	return (ToEigenVector(m.point(m.to_vertex_handle(h))) - ToEigenVector(m.point(m.from_vertex_handle(h)))).cast<double>().norm();
+}
+
+double LaplacianWeight(const HEMesh& m, OpenMesh::HalfedgeHandle h, LaplacianWeights type)
+{
+	switch (type)
+	{
+	case LaplacianWeights::Uniform:
+		return 1;
+	case LaplacianWeights::EdgeLength:
+		return EdgeLength(m, h);
+	case LaplacianWeights::InverseEdgeLength:
+	{
+		double length = EdgeLength(m, h);
+		return length == 0 ? 0 : 1 / length;
+	}
+	case LaplacianWeights::Cotangent:
+		return OppositeCotangent(m, h) + OppositeCotangent(m, m.opposite_halfedge_handle(h));
+	}
+	return 0;
+}
+
+void LaplacianMatrix::BuildPattern(const HEMesh& m)
+{
+	int n = (int)m.n_vertices();
+	matrix.resize(n, n);
+	matrix.makeCompressed();
+	matrix.resizeNonZeros((Eigen::Index)(n + m.n_halfedges()));
+	halfedgeEntry.assign(m.n_halfedges(), -1);
+	diagonalEntry.assign(n, -1);
+	edgeWeights.assign(m.n_edges(), 0);
+	numFaces = m.n_faces();
+	positions.clear();
+	halfedgeCotangents.clear();
+
+	int* outer = matrix.outerIndexPtr();
+	int* inner = matrix.innerIndexPtr();
+	outer[0] = 0;
+	for (int i = 0; i < n; ++i)
+		outer[i + 1] = outer[i] + 1 + (int)m.valence(m.vertex_handle(i));
+
+	//column i holds vertex i and its neighbors in ascending order
+	nse::util::ParallelFor(0, n, [&](size_t i)
+	{
+		auto v = m.vertex_handle((int)i);
+		std::vector<std::pair<int, int>> rows;
+		rows.emplace_back((int)i, -1);
+		for (auto h : m.voh_range(v))
+			rows.emplace_back(m.to_vertex_handle(h).idx(), h.idx());
+		std::sort(rows.begin(), rows.end());
+		int entry = outer[i];
+		for (auto& row : rows)
+		{
+			inner[entry] = row.first;
+			if (row.second < 0)
+				diagonalEntry[i] = entry;
+			else
+				halfedgeEntry[row.second] = entry;
+			++entry;
+		}
+	});
+	std::fill(matrix.valuePtr(), matrix.valuePtr() + matrix.nonZeros(), 0.0);
+}
+
+bool LaplacianMatrix::MatchesConnectivity(const HEMesh& m) const
+{
+	return diagonalEntry.size() == m.n_vertices() && halfedgeEntry.size() == m.n_halfedges() && numFaces == m.n_faces();
+}
+
+void LaplacianMatrix::Clear()
+{
+	matrix.resize(0, 0);
+	halfedgeEntry.clear();
+	diagonalEntry.clear();
+	edgeWeights.clear();
+	numFaces = 0;
+	positions.clear();
+	halfedgeCotangents.clear();
+}
+
+size_t LaplacianMatrix::UpdateWeights(const HEMesh& m, LaplacianWeights type)
+{
+	if (!MatchesConnectivity(m))
+		BuildPattern(m);
+
+	size_t updatedFaces = numFaces;
+	if (type == LaplacianWeights::Cotangent)
+	{
+		updatedFaces = UpdateCotangents(m);
+		if (updatedFaces == 0 && weights == type)
+			return 0;
+	}
+	else
+	{
+		positions.clear();
+		halfedgeCotangents.clear();
+		//every weight is computed once per edge
+		nse::util::ParallelFor(0, edgeWeights.size(), [&](size_t e)
+		{
+			edgeWeights[e] = LaplacianWeight(m, m.halfedge_handle(m.edge_handle((int)e), 0), type);
+		});
+	}
+	weights = type;
+
+	//every vertex only writes the values of its own column
+	double* values = matrix.valuePtr();
+	nse::util::ParallelFor(0, m.n_vertices(), [&](size_t i)
+	{
+		auto v = m.vertex_handle((int)i);
+		double sum = 0;
+		for (auto h : m.voh_range(v))
+		{
+			double w = edgeWeights[m.edge_handle(h).idx()];
+			values[halfedgeEntry[h.idx()]] = w;
+			sum += w;
+		}
+		values[diagonalEntry[i]] = -sum;
+	});
+	return updatedFaces;
+}
+
+size_t LaplacianMatrix::UpdateCotangents(const HEMesh& m)
+{
+	size_t nVertices = m.n_vertices();
+	bool reset = weights != LaplacianWeights::Cotangent || positions.size() != nVertices;
+	if (reset)
+	{
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+		positions.assign(nVertices, OpenMesh::Vec3f(nan, nan, nan));
+		halfedgeCotangents.assign(m.n_halfedges(), 0);
+	}
+
+	//find the moved vertices and remember their new positions
+	std::vector<unsigned char> moved(nVertices);
+	nse::util::ParallelFor(0, nVertices, [&](size_t v)
+	{
+		auto& p = m.point(m.vertex_handle((int)v));
+		//comparing the bits also catches the NaN positions of a discarded cache
+		moved[v] = std::memcmp(&p, &positions[v], sizeof(p)) != 0;
+		positions[v] = p;
+	});
+
+	//every face only writes the cotangents of its own halfedges
+	std::vector<unsigned char> faceUpdated(numFaces);
+	nse::util::ParallelFor(0, numFaces, [&](size_t i)
+	{
+		auto f = m.face_handle((int)i);
+		bool dirty = false;
+		for (auto v : m.fv_range(f))
+			dirty |= moved[v.idx()] != 0;
+		if (!dirty)
+			return;
+		faceUpdated[i] = 1;
+		for (auto h : m.fh_range(f))
+			halfedgeCotangents[h.idx()] = OppositeCotangent(m, h);
+	});
+
+	size_t updatedFaces = 0;
+	for (auto u : faceUpdated)
+		updatedFaces += u;
+	if (updatedFaces == 0 && !reset)
+		return 0;
+
+	//the halfedges of edge e have the indices 2e and 2e + 1
+	nse::util::ParallelFor(0, edgeWeights.size(), [&](size_t e)
+	{
+		edgeWeights[e] = halfedgeCotangents[2 * e] + halfedgeCotangents[2 * e + 1];
+	});
+	return updatedFaces;
+}
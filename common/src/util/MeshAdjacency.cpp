@@ -0,0 +1,72 @@
+#include "util/MeshAdjacency.h"
+
+void BuildMeshAdjacency(const HEMesh& m, MeshAdjacency& adjacency)
+{
+	std::size_t n = m.n_vertices();
+	adjacency.offsets.resize(n + 1);
+	adjacency.boundary.resize(n);
+	adjacency.neighbors.clear();
+	adjacency.neighbors.reserve(m.n_halfedges());
+
+	adjacency.offsets[0] = 0;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		auto v = m.vertex_handle((int)i);
+		for (auto vv : m.vv_range(v))
+			adjacency.neighbors.push_back(vv.idx());
+		adjacency.offsets[i + 1] = (unsigned int)adjacency.neighbors.size();
+		adjacency.boundary[i] = m.is_boundary(v) ? 1 : 0;
+	}
+}
+
+void GetVertexPositions(const HEMesh& m, std::vector<Eigen::Vector3f>& positions)
+{
+	positions.resize(m.n_vertices());
+	for (auto v : m.vertices())
+		positions[v.idx()] = ToEigenVector(m.point(v));
+}
+
+void SetVertexPositions(HEMesh& m, const std::vector<Eigen::Vector3f>& positions)
+{
+	for (auto v : m.vertices())
+		m.set_point(v, ToOpenMeshVector(positions[v.idx()]));
+}
+
+void ColorVertices(const MeshAdjacency& adjacency, VertexColoring& coloring)
+{
+	std::size_t n = adjacency.NumVertices();
+	const unsigned int uncolored = (unsigned int)-1;
+	std::vector<unsigned int> colors(n, uncolored);
+	//lastUser[c] == v + 1 marks color c as used by a neighbor of v
+	std::vector<std::size_t> lastUser;
+	std::vector<unsigned int> colorSizes;
+
+	for (std::size_t v = 0; v < n; ++v)
+	{
+		for (unsigned int j = adjacency.offsets[v]; j < adjacency.offsets[v + 1]; ++j)
+		{
+			unsigned int c = colors[adjacency.neighbors[j]];
+			if (c != uncolored)
+				lastUser[c] = v + 1;
+		}
+		unsigned int c = 0;
+		while (c < lastUser.size() && lastUser[c] == v + 1)
+			++c;
+		if (c == lastUser.size())
+		{
+			lastUser.push_back(0);
+			colorSizes.push_back(0);
+		}
+		colors[v] = c;
+		++colorSizes[c];
+	}
+
+	coloring.offsets.resize(colorSizes.size() + 1);
+	coloring.offsets[0] = 0;
+	for (std::size_t c = 0; c < colorSizes.size(); ++c)
+		coloring.offsets[c + 1] = coloring.offsets[c] + colorSizes[c];
+	coloring.vertices.resize(n);
+	std::vector<unsigned int> next(coloring.offsets.begin(), coloring.offsets.end() - 1);
+	for (std::size_t v = 0; v < n; ++v)
+		coloring.vertices[next[colors[v]]++] = (unsigned int)v;
+}
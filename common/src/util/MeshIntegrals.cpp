@@ -0,0 +1,135 @@
+#include "util/MeshIntegrals.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "util/Parallel.h"
+
+namespace
+{
+	//number of faces that are summed by one task
+	const std::size_t faceBlockSize = 4096;
+
+	//area and the ten volume integrals of 1, x, y, z, x^2, y^2, z^2, xy, yz, zx
+	const int integralCount = 11;
+
+	//Neumaier's improved Kahan summation
+	struct CompensatedSum
+	{
+		double sum = 0, compensation = 0;
+
+		void Add(double value)
+		{
+			double t = sum + value;
+			if (std::abs(sum) >= std::abs(value))
+				compensation += (sum - t) + value;
+			else
+				compensation += (value - t) + sum;
+			sum = t;
+		}
+
+		double Result() const { return sum + compensation; }
+	};
+
+	typedef std::array<CompensatedSum, integralCount> IntegralSums;
+
+	//polynomial terms of one coordinate of the triangle corners
+	void Subexpressions(double w0, double w1, double w2, double& f1, double& f2, double& f3, double& g0, double& g1, double& g2)
+	{
+		double temp0 = w0 + w1;
+		f1 = temp0 + w2;
+		double temp1 = w0 * w0;
+		double temp2 = temp1 + w1 * temp0;
+		f2 = temp2 + w2 * f1;
+		f3 = w0 * temp1 + w1 * temp2 + w2 * f2;
+		g0 = f2 + w0 * (f1 + w0);
+		g1 = f2 + w1 * (f1 + w1);
+		g2 = f2 + w2 * (f1 + w2);
+	}
+
+	//adds the contribution of the triangle (p0, p1, p2) to the sums
+	void AddTriangle(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const OpenMesh::Vec3f& p2, IntegralSums& sums)
+	{
+		double x0 = p0[0], y0 = p0[1], z0 = p0[2];
+		double x1 = p1[0], y1 = p1[1], z1 = p1[2];
+		double x2 = p2[0], y2 = p2[1], z2 = p2[2];
+
+		//unnormalized triangle normal
+		double a1 = x1 - x0, b1 = y1 - y0, c1 = z1 - z0;
+		double a2 = x2 - x0, b2 = y2 - y0, c2 = z2 - z0;
+		double d0 = b1 * c2 - b2 * c1;
+		double d1 = a2 * c1 - a1 * c2;
+		double d2 = a1 * b2 - a2 * b1;
+
+		double f1x, f2x, f3x, g0x, g1x, g2x;
+		double f1y, f2y, f3y, g0y, g1y, g2y;
+		double f1z, f2z, f3z, g0z, g1z, g2z;
+		Subexpressions(x0, x1, x2, f1x, f2x, f3x, g0x, g1x, g2x);
+		Subexpressions(y0, y1, y2, f1y, f2y, f3y, g0y, g1y, g2y);
+		Subexpressions(z0, z1, z2, f1z, f2z, f3z, g0z, g1z, g2z);
+
+		sums[0].Add(0.5 * std::sqrt(d0 * d0 + d1 * d1 + d2 * d2));
+		sums[1].Add(d0 * f1x);
+		sums[2].Add(d0 * f2x);
+		sums[3].Add(d1 * f2y);
+		sums[4].Add(d2 * f2z);
+		sums[5].Add(d0 * f3x);
+		sums[6].Add(d1 * f3y);
+		sums[7].Add(d2 * f3z);
+		sums[8].Add(d0 * (y0 * g0x + y1 * g1x + y2 * g2x));
+		sums[9].Add(d1 * (z0 * g0y + z1 * g1y + z2 * g2y));
+		sums[10].Add(d2 * (x0 * g0z + x1 * g1z + x2 * g2z));
+	}
+}
+
+MeshIntegrals ComputeMeshIntegrals(const HEMesh& m)
+{
+	std::size_t nFaces = m.n_faces();
+	std::vector<IntegralSums> blockSums((nFaces + faceBlockSize - 1) / faceBlockSize);
+
+	nse::util::ParallelForChunks(0, nFaces, faceBlockSize, [&](std::size_t block, std::size_t begin, std::size_t end, unsigned int)
+	{
+		auto& sums = blockSums[block];
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			//triangle fan around the first vertex of the face
+			auto h0 = m.halfedge_handle(m.face_handle((int)i));
+			auto& p0 = m.point(m.from_vertex_handle(h0));
+			auto h = m.next_halfedge_handle(h0);
+			auto hLast = m.prev_halfedge_handle(h0);
+			for (; h != hLast; h = m.next_halfedge_handle(h))
+				AddTriangle(p0, m.point(m.from_vertex_handle(h)), m.point(m.to_vertex_handle(h)), sums);
+		}
+	});
+
+	IntegralSums total;
+	for (auto& sums : blockSums)
+		for (int j = 0; j < integralCount; ++j)
+			total[j].Add(sums[j].Result());
+
+	const double mult[integralCount] = { 1.0, 1.0 / 6, 1.0 / 24, 1.0 / 24, 1.0 / 24, 1.0 / 60, 1.0 / 60, 1.0 / 60, 1.0 / 120, 1.0 / 120, 1.0 / 120 };
+	double intg[integralCount];
+	for (int j = 0; j < integralCount; ++j)
+		intg[j] = total[j].Result() * mult[j];
+
+	MeshIntegrals result;
+	result.area = intg[0];
+	result.volume = intg[1];
+	if (result.volume == 0)
+		return result;
+
+	Eigen::Vector3d& c = result.centroid;
+	c = Eigen::Vector3d(intg[2], intg[3], intg[4]) / result.volume;
+
+	//inertia relative to the centroid
+	double vol = result.volume;
+	Eigen::Matrix3d& I = result.inertia;
+	I(0, 0) = intg[6] + intg[7] - vol * (c.y() * c.y() + c.z() * c.z());
+	I(1, 1) = intg[5] + intg[7] - vol * (c.z() * c.z() + c.x() * c.x());
+	I(2, 2) = intg[5] + intg[6] - vol * (c.x() * c.x() + c.y() * c.y());
+	I(0, 1) = I(1, 0) = -(intg[8] - vol * c.x() * c.y());
+	I(1, 2) = I(2, 1) = -(intg[9] - vol * c.y() * c.z());
+	I(0, 2) = I(2, 0) = -(intg[10] - vol * c.z() * c.x());
+	return result;
+}
@@ -0,0 +1,48 @@
+#include "util/MeshNormals.h"
+
+#include <Eigen/Geometry>
+
+#include "util/Parallel.h"
+
+void ComputeFaceNormals(const HEMesh& m, std::vector<Eigen::Vector3f>& faceNormals)
+{
+	faceNormals.resize(m.n_faces());
+	nse::util::ParallelFor(0, m.n_faces(), [&](size_t i)
+	{
+		auto f = m.face_handle((unsigned int)i);
+		auto h = m.halfedge_handle(f);
+		Eigen::Vector3f p0 = ToEigenVector(m.point(m.from_vertex_handle(h)));
+		Eigen::Vector3f previous = ToEigenVector(m.point(m.to_vertex_handle(h))) - p0;
+		Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+		for (h = m.next_halfedge_handle(h); m.to_vertex_handle(h) != m.from_vertex_handle(m.halfedge_handle(f)); h = m.next_halfedge_handle(h))
+		{
+			Eigen::Vector3f current = ToEigenVector(m.point(m.to_vertex_handle(h))) - p0;
+			normal += previous.cross(current);
+			previous = current;
+		}
+		faceNormals[i] = normal;
+	});
+}
+
+void ComputeVertexNormals(const HEMesh& m, const std::vector<Eigen::Vector3f>& faceNormals, std::vector<Eigen::Vector3f>& vertexNormals)
+{
+	vertexNormals.resize(m.n_vertices());
+	nse::util::ParallelFor(0, m.n_vertices(), [&](size_t i)
+	{
+		Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+		for (auto h : m.voh_range(m.vertex_handle((unsigned int)i)))
+		{
+			auto f = m.face_handle(h);
+			if (f.is_valid())
+				normal += faceNormals[f.idx()];
+		}
+		vertexNormals[i] = normal;
+	});
+}
+
+void ComputeVertexNormals(const HEMesh& m, std::vector<Eigen::Vector3f>& vertexNormals)
+{
+	std::vector<Eigen::Vector3f> faceNormals;
+	ComputeFaceNormals(m, faceNormals);
+	ComputeVertexNormals(m, faceNormals, vertexNormals);
+}
@@ -1,21 +1,42 @@
 #include "util/OpenMeshUtils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
 #include <vector>
-#include <gui/ShaderPool.h>
 #include <random>
+#include <Eigen/LU>
+#include <gui/ShaderPool.h>
+#include "util/MeshNormals.h"
 
 MeshRenderer::MeshRenderer(const HEMesh& mesh)
 	: mesh(mesh), indexCount(0),
-	positionBuffer(nse::gui::VertexBuffer), normalBuffer(nse::gui::VertexBuffer), colorBuffer(nse::gui::VertexBuffer), texCoordBuffer(nse::gui::VertexBuffer),
+	positionBuffer(nse::gui::VertexBuffer), normalBuffer(nse::gui::VertexBuffer), texCoordBuffer(nse::gui::VertexBuffer),
 	indexBuffer(nse::gui::IndexBuffer),
-	texCoordBuffer4D(nse::gui::VertexBuffer), indexBufferTexCoords(nse::gui::IndexBuffer)
+	texCoordBuffer4D(nse::gui::VertexBuffer), indexBufferTexCoords(nse::gui::IndexBuffer),
+	faceColorBuffer(nse::gui::TextureBuffer)
 { 
 	vao.generate();	
 	vaoTexCoords.generate();
+	glGenTextures(1, &faceColorTexture);
+	emptyVao.generate();
+	glGenQueries(timerQueryFrames * timedRenderCalls * timedPasses, &timerQueries[0][0][0]);
 
 	Update();
 }
 
+MeshRenderer::~MeshRenderer()
+{
+	glDeleteTextures(1, &faceColorTexture);
+	glDeleteQueries(timerQueryFrames * timedRenderCalls * timedPasses, &timerQueries[0][0][0]);
+	GLuint framebuffers[] = { gBuffer, ssaoBuffer };
+	glDeleteFramebuffers(2, framebuffers);
+	GLuint textures[] = { gDepth, gNormal, gAlbedo, ssaoTexture, noiseTexture };
+	glDeleteTextures(5, textures);
+}
+
 //EmitVertexFunctor: void(const HEMesh::HalfedgeHandle[3]) //the to-vertices of the halfedges are the triangle corners
 template <typename EmitTriangleFunctor>
 void TriangulateMeshFace(HEMesh::FaceHandle f, const HEMesh& mesh, EmitTriangleFunctor&& emitTriangle)
@@ -39,107 +60,547 @@ void TriangulateMeshFace(HEMesh::FaceHandle f, const HEMesh& mesh, EmitTriangleF
 	}
 }
 
-void MeshRenderer::Update()
+void GetTriangleIndices(const HEMesh& mesh, std::vector<uint32_t>& indices, std::vector<uint32_t>* triangleFaces)
 {
-	if (mesh.n_vertices() == 0)
+	indices.clear();
+	indices.reserve(mesh.n_faces() * 3);
+	if (triangleFaces)
+	{
+		triangleFaces->clear();
+		triangleFaces->reserve(mesh.n_faces());
+	}
+	for (auto f : mesh.faces())
+	{
+		TriangulateMeshFace(f, mesh, [&](const HEMesh::HalfedgeHandle h[3])
+		{
+			indices.push_back(mesh.to_vertex_handle(h[0]).idx());
+			indices.push_back(mesh.to_vertex_handle(h[1]).idx());
+			indices.push_back(mesh.to_vertex_handle(h[2]).idx());
+			if (triangleFaces)
+				triangleFaces->push_back(f.idx());
+		});
+	}
+}
+
+void MeshRenderer::SetTriangleOrder(TriangleOrder order)
+{
+	triangleOrder = order;
+	meshOrderIndices.clear();
+	orderedIndices.clear();
+}
+
+void MeshRenderer::InvalidateBuffers()
+{
+	uploadedPositions.clear();
+	uploadedNormals.clear();
+	uploadedTexCoords.clear();
+	uploadedTexCoords4D.clear();
+	indexBufferHoldsTriangleList = false;
+	texCoordIndicesUploaded = false;
+}
+
+//changed elements that are at most this many elements apart are uploaded with a single call
+const size_t maxUploadGap = 256;
+
+//Layout of one vertex attribute for glVertexAttribPointer
+struct AttributeFormat
+{
+	int dim;
+	GLuint glType;
+	bool normalized;
+};
+
+//Uploads data to buffer and binds it to the attribute if its size in bytes differs from uploaded. Otherwise, only
+//the ranges of elements that differ from uploaded are written to the buffer. Afterwards, uploaded contains a copy
+//of data. Returns the number of uploaded bytes.
+template <typename Element>
+static size_t UploadChangedRanges(nse::gui::GLBuffer& buffer, const std::string& attribute, const AttributeFormat& format,
+	std::vector<uint8_t>& uploaded, const std::vector<Element>& data)
+{
+	const size_t elementSize = sizeof(Element);
+	const uint8_t* bytes = (const uint8_t*)data.data();
+	if (data.size() * elementSize != uploaded.size())
+	{
+		buffer.uploadAttributes((uint32_t)data.size(), (uint32_t)elementSize, format.dim, format.glType, format.normalized, bytes)
+			.bindToAttribute(attribute);
+		uploaded.assign(bytes, bytes + data.size() * elementSize);
+		return uploaded.size();
+	}
+
+	auto changed = [&](size_t i) { return std::memcmp(bytes + i * elementSize, uploaded.data() + i * elementSize, elementSize) != 0; };
+	size_t uploadedBytes = 0;
+	size_t i = 0;
+	while (i < data.size())
+	{
+		if (!changed(i))
+		{
+			++i;
+			continue;
+		}
+		//extend the range until a long enough run of unchanged elements follows
+		size_t begin = i, end = i + 1;
+		for (++i; i < data.size() && i - end < maxUploadGap; ++i)
+			if (changed(i))
+				end = i + 1;
+		size_t rangeBytes = (end - begin) * elementSize;
+		buffer.updateData(begin * elementSize, rangeBytes, bytes + begin * elementSize);
+		std::memcpy(uploaded.data() + begin * elementSize, bytes + begin * elementSize, rangeBytes);
+		uploadedBytes += rangeBytes;
+	}
+	return uploadedBytes;
+}
+
+//converts a float to the bits of an IEEE half float, rounding to nearest
+static uint16_t FloatToHalf(float value)
+{
+	uint32_t f;
+	std::memcpy(&f, &value, sizeof(f));
+	uint16_t sign = (uint16_t)((f >> 16) & 0x8000);
+	int exponent = (int)((f >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = f & 0x7fffff;
+	if (exponent >= 31)
+		//overflow, infinity and NaN
+		return sign | (((f >> 23) & 0xff) == 0xff && mantissa ? 0x7e00 : 0x7c00);
+	if (exponent <= 0)
+	{
+		//denormalized half or zero
+		if (exponent < -10)
+			return sign;
+		mantissa |= 0x800000;
+		uint32_t shift = 14 - exponent;
+		return sign | (uint16_t)((mantissa + (1u << (shift - 1))) >> shift);
+	}
+	//a carry from the rounding correctly increments the exponent
+	return sign | (uint16_t)(((exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+//normalizes n and packs it into GL_INT_2_10_10_10_REV with components in [-511, 511] and w = 0
+static uint32_t PackNormal(const Eigen::Vector3f& n)
+{
+	float length = n.norm();
+	uint32_t packed = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		float unit = length > 0 ? n[i] / length : 0.0f;
+		int component = (int)std::lround(std::max(-1.0f, std::min(1.0f, unit)) * 511.0f);
+		packed |= ((uint32_t)component & 0x3ff) << (10 * i);
+	}
+	return packed;
+}
+
+void MeshRenderer::SetVertexFormat(VertexFormat format)
+{
+	vertexFormat = format;
+	InvalidateBuffers();
+}
+
+size_t MeshRenderer::GPUMemoryBytes() const
+{
+	return positionBuffer.bufferSize() + normalBuffer.bufferSize() + faceColorBuffer.bufferSize() + texCoordBuffer.bufferSize()
+		+ texCoordBuffer4D.bufferSize() + indexBuffer.bufferSize() + indexBufferTexCoords.bufferSize();
+}
+
+void MeshRenderer::UploadAttributes(const std::vector<Eigen::Vector3f>& positions, const std::vector<Eigen::Vector3f>& normals,
+	const std::vector<Eigen::Vector2f>& uvs)
+{
+	positionOffset.setZero();
+	positionScale.setOnes();
+	if (vertexFormat == VertexFormat::Float)
+	{
+		std::vector<Eigen::Vector4f> positions4, normals4;
+		positions4.reserve(positions.size());
+		normals4.reserve(normals.size());
+		for (auto& p : positions)
+			positions4.push_back(Eigen::Vector4f(p.x(), p.y(), p.z(), 1));
+		for (auto& n : normals)
+			normals4.push_back(Eigen::Vector4f(n.x(), n.y(), n.z(), 0));
+		uploadedBytes += UploadChangedRanges(positionBuffer, "position", { 4, GL_FLOAT, false }, uploadedPositions, positions4);
+		uploadedBytes += UploadChangedRanges(normalBuffer, "normal", { 4, GL_FLOAT, false }, uploadedNormals, normals4);
+		if (!uvs.empty())
+			uploadedBytes += UploadChangedRanges(texCoordBuffer, "texCoords", { 2, GL_FLOAT, false }, uploadedTexCoords, uvs);
 		return;
+	}
 
-	ShaderPool::Instance()->meshShader.bind();
-	vao.bind();
+	if (vertexFormat == VertexFormat::Packed)
+		uploadedBytes += UploadChangedRanges(positionBuffer, "position", { 3, GL_FLOAT, false }, uploadedPositions, positions);
+	else
+	{
+		//the w coordinate of 65535 becomes 1 in the shader
+		typedef Eigen::Matrix<uint16_t, 4, 1> QuantizedPosition;
+		Eigen::Vector3f lower = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+		Eigen::Vector3f upper = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+		for (auto& p : positions)
+		{
+			lower = lower.cwiseMin(p);
+			upper = upper.cwiseMax(p);
+		}
+		positionOffset = lower;
+		positionScale = (upper - lower).cwiseMax(Eigen::Vector3f::Constant(1e-30f));
+		Eigen::Vector3f toGrid = positionScale.cwiseInverse() * 65535.0f;
+		std::vector<QuantizedPosition> quantized;
+		quantized.reserve(positions.size());
+		for (auto& p : positions)
+		{
+			Eigen::Vector3f grid = (p - positionOffset).cwiseProduct(toGrid);
+			quantized.push_back(QuantizedPosition((uint16_t)std::lround(grid.x()), (uint16_t)std::lround(grid.y()), (uint16_t)std::lround(grid.z()), 65535));
+		}
+		uploadedBytes += UploadChangedRanges(positionBuffer, "position", { 4, GL_UNSIGNED_SHORT, true }, uploadedPositions, quantized);
+	}
+
+	std::vector<uint32_t> packedNormals;
+	packedNormals.reserve(normals.size());
+	for (auto& n : normals)
+		packedNormals.push_back(PackNormal(n));
+	//not normalized: GL 3.3 maps signed normalized values with (2c + 1) / (2^b - 1), which turns the zero w into 1/3,
+	//the shaders use the integer direction with w = 0 and normalize after the interpolation
+	uploadedBytes += UploadChangedRanges(normalBuffer, "normal", { 4, GL_INT_2_10_10_10_REV, false }, uploadedNormals, packedNormals);
 
-	std::vector<Eigen::Vector4f> positions;
-	std::vector<Eigen::Vector4f> normals;
+	if (!uvs.empty())
+	{
+		std::vector<Eigen::Matrix<uint16_t, 2, 1>> halfUVs;
+		halfUVs.reserve(uvs.size());
+		for (auto& uv : uvs)
+			halfUVs.push_back(Eigen::Matrix<uint16_t, 2, 1>(FloatToHalf(uv.x()), FloatToHalf(uv.y())));
+		uploadedBytes += UploadChangedRanges(texCoordBuffer, "texCoords", { 2, GL_HALF_FLOAT, false }, uploadedTexCoords, halfUVs);
+	}
+}
+
+void MeshRenderer::SetPositionDecoding(nse::gui::GLShader& shader) const
+{
+	shader.setUniform("positionOffset", positionOffset, false);
+	shader.setUniform("positionScale", positionScale, false);
+}
+
+//texture unit of the face color buffer texture
+const int faceColorTextureUnit = 0;
+
+void MeshRenderer::SetFaceColors(nse::gui::GLShader& shader) const
+{
+	shader.setUniform("perFaceColor", hasColor ? 1 : 0, false);
+	if (!hasColor)
+		return;
+	glActiveTexture(GL_TEXTURE0 + faceColorTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, faceColorTexture);
+	shader.setUniform("faceColors", faceColorTextureUnit, false);
+}
+
+//radius of the SSAO hemisphere relative to the bounding box diagonal of the mesh
+const float ssaoRadiusScale = 0.05f;
+
+void MeshRenderer::UploadVertexBuffers()
+{
+	std::vector<Eigen::Vector3f> positions;
+	std::vector<Eigen::Vector3f> normals;
 	std::vector<Eigen::Vector2f> uvs;
 	positions.reserve(mesh.n_vertices());
-	normals.reserve(mesh.n_vertices());
 	if(mesh.has_vertex_texcoords2D())
 		uvs.reserve(mesh.n_vertices());
 	for (auto v : mesh.vertices())
 	{
-		positions.push_back(ToEigenVector4(mesh.point(v)));
-		OpenMesh::Vec3f n;
-		mesh.calc_vertex_normal_correct(v, n);
-		normals.push_back(ToEigenVector4(n, 0));
+		positions.push_back(ToEigenVector(mesh.point(v)));
 		if (mesh.has_vertex_texcoords2D())
 			uvs.push_back(ToEigenVector(mesh.texcoord2D(v)));
 	}
-	positionBuffer.uploadData(positions).bindToAttribute("position");
-	normalBuffer.uploadData(normals).bindToAttribute("normal");
-	if (mesh.has_vertex_texcoords2D())
-		texCoordBuffer.uploadData(uvs).bindToAttribute("texCoords");
+	ComputeVertexNormals(mesh, normals);
+	UploadAttributes(positions, normals, uvs);
 
-	std::vector<uint32_t> indices;
-	indices.reserve(mesh.n_faces() * 3);
-	for (auto f : mesh.faces())
+	Eigen::Vector3f lower = positions[0], upper = positions[0];
+	for (auto& p : positions)
 	{
-		TriangulateMeshFace(f, mesh, [&](const HEMesh::HalfedgeHandle h[3])
+		lower = lower.cwiseMin(p);
+		upper = upper.cwiseMax(p);
+	}
+	ssaoRadius = ssaoRadiusScale * (upper - lower).norm();
+}
+
+void MeshRenderer::Update()
+{
+	uploadedBytes = 0;
+	if (mesh.n_vertices() == 0)
+		return;
+
+	ShaderPool::Instance()->meshShader.bind();
+	vao.bind();
+
+	UploadVertexBuffers();
+
+	//the triangle lists are reused if the connectivity has not changed
+	if (meshOrderIndices.empty() || indexedRevision != connectivityRevision
+		|| indexedVertices != mesh.n_vertices() || indexedFaces != mesh.n_faces())
+	{
+		GetTriangleIndices(mesh, meshOrderIndices, &orderedTriangleFaces);
+		orderedIndices = meshOrderIndices;
+		indexedRevision = connectivityRevision;
+		indexedVertices = mesh.n_vertices();
+		indexedFaces = mesh.n_faces();
+		if (triangleOrder != TriangleOrder::Original)
+			OptimizeVertexCache(orderedIndices, mesh.n_vertices(), &orderedTriangleFaces);
+		if (triangleOrder == TriangleOrder::VertexCacheAndOverdraw)
 		{
-			indices.push_back(mesh.to_vertex_handle(h[0]).idx());
-			indices.push_back(mesh.to_vertex_handle(h[1]).idx());
-			indices.push_back(mesh.to_vertex_handle(h[2]).idx());
-		});
+			std::vector<Eigen::Vector3f> positions(mesh.n_vertices());
+			for (auto v : mesh.vertices())
+				positions[v.idx()] = ToEigenVector(mesh.point(v));
+			OptimizeOverdraw(orderedIndices, positions, 1.05f, &orderedTriangleFaces);
+		}
+		originalCacheStatistics = AnalyzeVertexCache(meshOrderIndices, mesh.n_vertices());
+		cacheStatistics = AnalyzeVertexCache(orderedIndices, mesh.n_vertices());
+		indexBufferHoldsTriangleList = false;
 	}
-	indexBuffer.uploadData(sizeof(uint32_t) * (uint32_t)indices.size(), indices.data());
-	indexCount = (unsigned int)indices.size();
+	if (indexBufferHoldsTriangleList)
+		//the vertex array may have lost the binding in the per-face color mode
+		indexBuffer.bind();
+	else
+	{
+		indexBuffer.uploadData(sizeof(uint32_t) * (uint32_t)orderedIndices.size(), orderedIndices.data());
+		uploadedBytes += sizeof(uint32_t) * orderedIndices.size();
+		indexBufferHoldsTriangleList = true;
+	}
+	indexCount = (unsigned int)orderedIndices.size();
 
 	vao.unbind();
 
 	hasColor = false;
+	primitiveType = GL_TRIANGLES;
 
 	UpdateTextureMapBuffers();
-	// UpdateSSAOBuffers();
 }
 
-void MeshRenderer::UpdateWithPerFaceColor(OpenMesh::FPropHandleT<Eigen::Vector4f> colorProperty)
+void MeshRenderer::UpdateGeometry()
 {
+	uploadedBytes = 0;
 	if (mesh.n_vertices() == 0)
 		return;
 
 	ShaderPool::Instance()->meshShader.bind();
 	vao.bind();
+	UploadVertexBuffers();
+	vao.unbind();
+}
 
-	std::vector<Eigen::Vector4f> positions;
-	std::vector<Eigen::Vector4f> normals;
-	std::vector<Eigen::Vector4f> colors;
-	std::vector<Eigen::Vector2f> uvs;
-	positions.reserve(3 * mesh.n_faces());
-	normals.reserve(3 * mesh.n_faces());
-	colors.reserve(3 * mesh.n_faces());
-	if (mesh.has_vertex_texcoords2D())
-		uvs.reserve(3 * mesh.n_faces());
+//returns the halfedge of triangle f that connects the vertices a and b in any direction
+static OpenMesh::HalfedgeHandle FindTriangleEdge(const HEMesh& mesh, OpenMesh::FaceHandle f, uint32_t a, uint32_t b)
+{
+	for (auto h : mesh.fh_range(f))
+	{
+		uint32_t from = mesh.from_vertex_handle(h).idx();
+		uint32_t to = mesh.to_vertex_handle(h).idx();
+		if ((from == a && to == b) || (from == b && to == a))
+			return h;
+	}
+	return OpenMesh::HalfedgeHandle();
+}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);	
+TriangleStripStatistics BuildTriangleStripIndices(const HEMesh& mesh, OpenMesh::FPropHandleT<int> stripIdProperty, std::vector<uint32_t>& indices)
+{
+	TriangleStripStatistics stats;
+	indices.clear();
+	indices.reserve(mesh.n_faces() * 2);
+
+	auto beginStrip = [&]()
+	{
+		if (stats.strips > 0)
+			indices.push_back(StripRestartIndex);
+		++stats.strips;
+	};
 
+	//polygons are drawn as a strip of the same triangle fan that TriangulateMeshFace produces
+	std::vector<uint32_t> polygon;
 	for (auto f : mesh.faces())
 	{
-		TriangulateMeshFace(f, mesh, [&](const HEMesh::HalfedgeHandle h[3])
+		if (mesh.valence(f) <= 3)
+			continue;
+		polygon.clear();
+		for (auto h : mesh.fh_range(f))
+			polygon.push_back(mesh.to_vertex_handle(h).idx());
+		beginStrip();
+		indices.push_back(polygon[1]);
+		indices.push_back(polygon[2]);
+		indices.push_back(polygon[0]);
+		for (size_t i = 3; i < polygon.size(); ++i)
 		{
-			for (int i = 0; i < 3; ++i)
+			//the fan triangles share the edge (v0, vi-1), which is every other time not at the end of the strip
+			if (indices.back() != polygon[0] && indices[indices.size() - 2] != polygon[0])
 			{
-				auto v = mesh.to_vertex_handle(h[i]);
-				positions.push_back(ToEigenVector4(mesh.point(v)));
-				OpenMesh::Vec3f n;
-				mesh.calc_vertex_normal_correct(v, n);
-				normals.push_back(ToEigenVector4(n, 0));
-				colors.push_back(mesh.property(colorProperty, f));
-				if (mesh.has_vertex_texcoords2D())
-					uvs.push_back(ToEigenVector(mesh.texcoord2D(v)));
-			}			
-		});
+				uint32_t p = indices[indices.size() - 3], r = indices.back();
+				indices.push_back(r);
+				indices.push_back(p);
+				++stats.swaps;
+			}
+			indices.push_back(polygon[i]);
+		}
+		stats.triangles += polygon.size() - 2;
 	}
-	positionBuffer.uploadData(positions).bindToAttribute("position");
-	normalBuffer.uploadData(normals).bindToAttribute("normal");
-	colorBuffer.uploadData(colors).bindToAttribute("color");
-	if (mesh.has_vertex_texcoords2D())
-		texCoordBuffer.uploadData(uvs).bindToAttribute("texCoords");
 
-	indexCount = (unsigned int)positions.size();
+	//group the triangles by strip id with a counting sort, triangles with negative ids come last
+	int maxId = -1;
+	for (auto f : mesh.faces())
+		maxId = std::max(maxId, mesh.property(stripIdProperty, f));
+	std::vector<size_t> offsets(maxId + 3, 0);
+	auto group = [&](OpenMesh::FaceHandle f)
+	{
+		int id = mesh.property(stripIdProperty, f);
+		return id < 0 ? maxId + 1 : id;
+	};
+	for (auto f : mesh.faces())
+		if (mesh.valence(f) == 3)
+			++offsets[group(f) + 1];
+	for (size_t i = 1; i < offsets.size(); ++i)
+		offsets[i] += offsets[i - 1];
+	std::vector<OpenMesh::FaceHandle> sortedFaces(offsets.back());
+	{
+		std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+		for (auto f : mesh.faces())
+			if (mesh.valence(f) == 3)
+				sortedFaces[next[group(f)]++] = f;
+	}
+
+	std::vector<unsigned char> emitted(mesh.n_faces(), 0);
+	//returns the unemitted triangle across h if it belongs to the same strip as the face of h
+	auto neighborInStrip = [&](OpenMesh::HalfedgeHandle h)
+	{
+		auto o = mesh.opposite_halfedge_handle(h);
+		if (mesh.is_boundary(o))
+			return OpenMesh::FaceHandle();
+		auto f = mesh.face_handle(h);
+		auto g = mesh.face_handle(o);
+		int id = mesh.property(stripIdProperty, f);
+		if (id < 0 || emitted[g.idx()] || mesh.property(stripIdProperty, g) != id || mesh.valence(g) != 3)
+			return OpenMesh::FaceHandle();
+		return g;
+	};
+
+	std::vector<OpenMesh::FaceHandle> starts;
+	for (int id = 0; id <= maxId + 1; ++id)
+	{
+		//strips are started at the ends of the paths first
+		starts.clear();
+		for (int pass = 0; pass < 2; ++pass)
+			for (size_t i = offsets[id]; i < offsets[id + 1]; ++i)
+			{
+				auto f = sortedFaces[i];
+				int neighbors = 0;
+				for (auto h : mesh.fh_range(f))
+					if (neighborInStrip(h).is_valid())
+						++neighbors;
+				if ((neighbors <= 1) == (pass == 0))
+					starts.push_back(f);
+			}
+
+		for (auto start : starts)
+		{
+			if (emitted[start.idx()])
+				continue;
+			beginStrip();
+			emitted[start.idx()] = 1;
+			++stats.triangles;
+
+			OpenMesh::HalfedgeHandle exit;
+			for (auto h : mesh.fh_range(start))
+				if (neighborInStrip(h).is_valid())
+				{
+					exit = h;
+					break;
+				}
+			if (!exit.is_valid())
+			{
+				for (auto h : mesh.fh_range(start))
+					indices.push_back(mesh.to_vertex_handle(h).idx());
+				continue;
+			}
+
+			//the first triangle ends with the shared edge, which keeps its orientation
+			indices.push_back(mesh.to_vertex_handle(mesh.next_halfedge_handle(exit)).idx());
+			indices.push_back(mesh.from_vertex_handle(exit).idx());
+			indices.push_back(mesh.to_vertex_handle(exit).idx());
+
+			while (exit.is_valid())
+			{
+				auto entry = mesh.opposite_halfedge_handle(exit);
+				auto f = mesh.face_handle(entry);
+				emitted[f.idx()] = 1;
+				++stats.triangles;
+				indices.push_back(mesh.to_vertex_handle(mesh.next_halfedge_handle(entry)).idx());
+
+				//the last three indices are the corners p, q, r of f. The strip continues across (q, r), or across
+				//(p, r) after repeating r and p, which adds two degenerate triangles but keeps the orientation.
+				size_t n = indices.size();
+				uint32_t p = indices[n - 3], q = indices[n - 2], r = indices[n - 1];
+				exit = FindTriangleEdge(mesh, f, q, r);
+				if (!neighborInStrip(exit).is_valid())
+				{
+					exit = FindTriangleEdge(mesh, f, p, r);
+					if (neighborInStrip(exit).is_valid())
+					{
+						indices.push_back(r);
+						indices.push_back(p);
+						++stats.swaps;
+					}
+					else
+						exit = OpenMesh::HalfedgeHandle();
+				}
+			}
+		}
+	}
+
+	stats.stripIndices = indices.size();
+	stats.triangleListIndices = 3 * stats.triangles;
+	return stats;
+}
+
+TriangleStripStatistics MeshRenderer::UpdateWithTriangleStrips(OpenMesh::FPropHandleT<int> stripIdProperty)
+{
+	TriangleStripStatistics stats;
+	if (mesh.n_vertices() == 0)
+		return stats;
+
+	uploadedBytes = 0;
+	ShaderPool::Instance()->meshShader.bind();
+	vao.bind();
+
+	UploadVertexBuffers();
+
+	std::vector<uint32_t> indices;
+	stats = BuildTriangleStripIndices(mesh, stripIdProperty, indices);
+	indexBuffer.uploadData(sizeof(uint32_t) * (uint32_t)indices.size(), indices.data());
+	uploadedBytes += sizeof(uint32_t) * indices.size();
+	indexBufferHoldsTriangleList = false;
+	indexCount = (unsigned int)indices.size();
 
 	vao.unbind();
 
-	hasColor = true;
+	hasColor = false;
+	primitiveType = GL_TRIANGLE_STRIP;
 
 	UpdateTextureMapBuffers();
+	return stats;
+}
+
+void MeshRenderer::UpdateWithPerFaceColor(OpenMesh::FPropHandleT<Eigen::Vector4f> colorProperty)
+{
+	Update();
+	if (mesh.n_vertices() == 0)
+		return;
+
+	faceColorProperty = colorProperty;
+	UploadFaceColors();
+	hasColor = true;
+}
+
+void MeshRenderer::UploadFaceColors()
+{
+	std::vector<Eigen::Matrix<uint8_t, 4, 1>> colors;
+	colors.reserve(orderedTriangleFaces.size());
+	for (auto f : orderedTriangleFaces)
+	{
+		const Eigen::Vector4f& c = mesh.property(faceColorProperty, mesh.face_handle(f));
+		colors.push_back((c.cwiseMax(0.0f).cwiseMin(1.0f) * 255.0f).array().round().cast<uint8_t>().matrix());
+	}
+	faceColorBuffer.uploadData(sizeof(Eigen::Matrix<uint8_t, 4, 1>) * (uint32_t)colors.size(), colors.data());
+	uploadedBytes += faceColorBuffer.bufferSize();
+
+	glBindTexture(GL_TEXTURE_BUFFER, faceColorTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA8, faceColorBuffer.bufferId());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
 }
 
 void MeshRenderer::UpdateTextureMapBuffers()
@@ -156,151 +617,307 @@ void MeshRenderer::UpdateTextureMapBuffers()
 	for (auto v : mesh.vertices())
 		positions.push_back(ToEigenVector4(mesh.texcoord2D(v)));		
 
-	texCoordBuffer4D.uploadData(positions).bindToAttribute("position");
+	uploadedBytes += UploadChangedRanges(texCoordBuffer4D, "position", { 4, GL_FLOAT, false }, uploadedTexCoords4D, positions);
 
-	std::vector<uint32_t> indices;
-	indices.reserve(mesh.n_edges() * 2);
-	for (auto e : mesh.edges())
+	//the edges are reused if the connectivity has not changed
+	if (!texCoordIndicesUploaded || texCoordIndexedRevision != connectivityRevision
+		|| texCoordIndexedVertices != mesh.n_vertices() || texCoordIndexedEdges != mesh.n_edges())
 	{
-		auto h = mesh.halfedge_handle(e, 0);
-		indices.push_back(mesh.from_vertex_handle(h).idx());
-		indices.push_back(mesh.to_vertex_handle(h).idx());
+		std::vector<uint32_t> indices;
+		indices.reserve(mesh.n_edges() * 2);
+		for (auto e : mesh.edges())
+		{
+			auto h = mesh.halfedge_handle(e, 0);
+			indices.push_back(mesh.from_vertex_handle(h).idx());
+			indices.push_back(mesh.to_vertex_handle(h).idx());
+		}
+		indexBufferTexCoords.uploadData(sizeof(uint32_t) * (uint32_t)indices.size(), indices.data());
+		uploadedBytes += sizeof(uint32_t) * indices.size();
+		indexCountTexCoords = (unsigned int)indices.size();
+		texCoordIndicesUploaded = true;
+		texCoordIndexedRevision = connectivityRevision;
+		texCoordIndexedVertices = mesh.n_vertices();
+		texCoordIndexedEdges = mesh.n_edges();
 	}
-	indexBufferTexCoords.uploadData(sizeof(uint32_t) * (uint32_t)indices.size(), indices.data());
-	indexCountTexCoords = (unsigned int)indices.size();
 
 	vaoTexCoords.unbind();
 }
 
-//float MeshRenderer::lerp(float a, float b, float f)
-//{
-//	return a + f * (b - a);
-//}
-
-//void MeshRenderer::UpdateSSAOBuffers()
-//{
-//	const GLuint SCR_WIDTH = 1280, SCR_HEIGHT = 720;
-//
-//	glGenFramebuffers(1, &gBuffer);
-//	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-//
-//	// - Position color buffer
-//	glGenTextures(1, &gPosition);
-//	glBindTexture(GL_TEXTURE_2D, gPosition);
-//	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGB, GL_FLOAT, NULL);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-//	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-//
-//	// - Normal color buffer
-//	glGenTextures(1, &gNormal);
-//	glBindTexture(GL_TEXTURE_2D, gNormal);
-//	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGB, GL_FLOAT, NULL);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-//	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-//
-//	// - Color + Specular color buffer
-//	glGenTextures(1, &gAlbedo);
-//	glBindTexture(GL_TEXTURE_2D, gAlbedo);
-//	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-//	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
-//
-//	// - Tell OpenGL which color attachments we'll use (of this framebuffer) for rendering
-//	GLuint attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
-//	glDrawBuffers(3, attachments);
-//
-//	// generate sample kernel
-//	// ----------------------
-//	std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0); // generates random floats between 0.0 and 1.0
-//	std::default_random_engine generator;
-//	for (unsigned int i = 0; i < 64; ++i)
-//	{
-//		Eigen::Vector3f sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator));
-//		sample.normalize();
-//		sample *= randomFloats(generator);
-//		float scale = float(i) / 64.0f;
-//
-//		// scale samples s.t. they're more aligned to center of kernel
-//		scale = MeshRenderer::lerp(0.1f, 1.0f, scale * scale);
-//		sample *= scale;
-//		ssaoKernel.push_back(sample);
-//	}
-//
-//	// generate noise texture
-//	// ----------------------
-//	std::vector<Eigen::Vector3f> ssaoNoise;
-//	for (unsigned int i = 0; i < 16; i++)
-//	{
-//		Eigen::Vector3f noise(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, 0.0f);
-//		ssaoNoise.push_back(noise);
-//	}
-//	glGenTextures(1, &noiseTexture);
-//	glBindTexture(GL_TEXTURE_2D, noiseTexture);
-//	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, 4, 4, 0, GL_RGB, GL_FLOAT, &ssaoNoise[0]);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-//}
-
-void MeshRenderer::Render(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const
+void MeshRenderer::Draw() const
 {
-	if (indexCount == 0)
-		return;
-
-	MeshRenderer::RenderGBuffer(view, projection, flatShading, withTexCoords, color);
-	MeshRenderer::RenderSSAO(view, projection, flatShading, withTexCoords, color);
+	vao.bind();
+	if (primitiveType == GL_TRIANGLE_STRIP)
+	{
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(StripRestartIndex);
+		glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+	else
+		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+	vao.unbind();
+}
 
-	auto& shader = ShaderPool::Instance()->meshShader;
+void MeshRenderer::SetMaterialUniforms(nse::gui::GLShader& shader, const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection,
+	bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const
+{
 	shader.bind();
 	shader.setUniform("view", view);
 	shader.setUniform("proj", projection);
 	shader.setUniform("flatShading", flatShading ? 1 : 0);
-	shader.setUniform("perVertexColor", hasColor ? 1 : 0);
+	SetFaceColors(shader);
 	shader.setUniform("visualizeTexCoords", withTexCoords ? 1 : 0);
 	shader.setUniform("color", color);
+	SetPositionDecoding(shader);
+}
 
-	vao.bind();
-	if (hasColor)
-		glDrawArrays(GL_TRIANGLES, 0, indexCount);
-	else
-		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-	vao.unbind();
+//indices of the timed passes in RenderPassTimes
+enum TimedPass { GeometryPass, SSAOPass, LightingPass };
+
+void MeshRenderer::BeginFrame()
+{
+	timerQueryFrame = (timerQueryFrame + 1) % timerQueryFrames;
+	frameRenderCalls = 0;
+	ReadPassTimes();
 }
 
-void MeshRenderer::RenderGBuffer(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const {
-	auto& shader = ShaderPool::Instance()->geometryShader;
-	shader.bind();
+void MeshRenderer::Render(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const
+{
+	if (indexCount == 0)
+		return;
 
-	vao.bind();
-	if (hasColor)
-		glDrawArrays(GL_TRIANGLES, 0, indexCount);
+	if (renderPath == RenderPath::Deferred)
+		RenderDeferred(view, projection, flatShading, withTexCoords, color);
 	else
-		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-	vao.unbind();
+		RenderForward(view, projection, flatShading, withTexCoords, color);
+	++frameRenderCalls;
 }
 
-void MeshRenderer::RenderSSAO(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const {
-	auto& shader = ShaderPool::Instance()->ssaoShader;
-	shader.bind();
-	shader.setUniform("view", view);
-	shader.setUniform("proj", projection);
-	shader.setUniform("flatShading", flatShading ? 1 : 0);
-	shader.setUniform("perVertexColor", hasColor ? 1 : 0);
-	shader.setUniform("visualizeTexCoords", withTexCoords ? 1 : 0);
-	shader.setUniform("color", color);
+void MeshRenderer::RenderForward(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const
+{
+	BeginPassTimer(GeometryPass);
+	SetMaterialUniforms(ShaderPool::Instance()->meshShader, view, projection, flatShading, withTexCoords, color);
+	Draw();
+	EndPassTimer();
+}
 
-	vao.bind();
-	if (hasColor)
-		glDrawArrays(GL_TRIANGLES, 0, indexCount);
-	else
-		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-	vao.unbind();
+//number of samples of the SSAO kernel, must match ssao.frag
+const int ssaoKernelSize = 16;
+//the noise texture has noiseSize x noiseSize random rotations
+const int noiseSize = 4;
+
+//texture units of the full-screen passes
+const int depthTextureUnit = 0;
+const int normalTextureUnit = 1;
+const int albedoTextureUnit = 2;
+const int noiseTextureUnit = 3;
+const int ssaoTextureUnit = 4;
+
+//allocates the storage of a render target texture that is read with texelFetch
+static void AllocateTargetTexture(GLuint texture, GLint internalFormat, int width, int height, GLenum format, GLenum type)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+bool MeshRenderer::PrepareDeferredTargets(int width, int height) const
+{
+	if (gBuffer == 0)
+	{
+		glGenFramebuffers(1, &gBuffer);
+		glGenFramebuffers(1, &ssaoBuffer);
+		GLuint textures[4];
+		glGenTextures(4, textures);
+		gDepth = textures[0];
+		gNormal = textures[1];
+		gAlbedo = textures[2];
+		ssaoTexture = textures[3];
+
+		//hemisphere samples around the z axis, most of them close to the center
+		std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f);
+		std::default_random_engine generator;
+		ssaoKernel.clear();
+		for (int i = 0; i < ssaoKernelSize; ++i)
+		{
+			Eigen::Vector3f sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator));
+			sample = sample.normalized() * randomFloats(generator);
+			float scale = (float)i / ssaoKernelSize;
+			sample *= 0.1f + 0.9f * scale * scale;
+			ssaoKernel.push_back(sample);
+		}
+
+		//random rotations of the kernel around the normal
+		std::vector<Eigen::Vector3f> noise;
+		for (int i = 0; i < noiseSize * noiseSize; ++i)
+			noise.push_back(Eigen::Vector3f(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, 0.0f));
+		glGenTextures(1, &noiseTexture);
+		AllocateTargetTexture(noiseTexture, GL_RGB16F, noiseSize, noiseSize, GL_RGB, GL_FLOAT);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, noiseSize, noiseSize, GL_RGB, GL_FLOAT, noise.data());
+	}
+
+	if (width != targetWidth || height != targetHeight)
+	{
+		targetWidth = width;
+		targetHeight = height;
+		AllocateTargetTexture(gDepth, GL_DEPTH_COMPONENT24, width, height, GL_DEPTH_COMPONENT, GL_FLOAT);
+		AllocateTargetTexture(gNormal, GL_RGBA16F, width, height, GL_RGBA, GL_FLOAT);
+		AllocateTargetTexture(gAlbedo, GL_RGBA8, width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+		AllocateTargetTexture(ssaoTexture, GL_R8, (width + 1) / 2, (height + 1) / 2, GL_RED, GL_UNSIGNED_BYTE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gDepth, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gNormal, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gAlbedo, 0);
+		GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, attachments);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, ssaoBuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoTexture, 0);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBuffer);
+	complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	return complete;
+}
+
+void MeshRenderer::DrawFullScreenTriangle() const
+{
+	emptyVao.bind();
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	emptyVao.unbind();
+}
+
+void MeshRenderer::RenderDeferred(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading, bool withTexCoords, const Eigen::Vector4f& color) const
+{
+	GLint viewport[4], targetFramebuffer;
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+
+	if (viewport[2] <= 0 || viewport[3] <= 0 || !PrepareDeferredTargets(viewport[2], viewport[3]))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+		RenderForward(view, projection, flatShading, withTexCoords, color);
+		return;
+	}
+	Eigen::Matrix4f inverseProjection = projection.inverse();
+
+	//the only pass that draws the mesh, background texels keep the cleared depth of 1
+	BeginPassTimer(GeometryPass);
+	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+	glViewport(0, 0, targetWidth, targetHeight);
+	glEnable(GL_DEPTH_TEST);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	SetMaterialUniforms(ShaderPool::Instance()->geometryShader, view, projection, flatShading, withTexCoords, color);
+	Draw();
+	EndPassTimer();
+
+	glActiveTexture(GL_TEXTURE0 + depthTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, gDepth);
+	glActiveTexture(GL_TEXTURE0 + normalTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, gNormal);
+	glActiveTexture(GL_TEXTURE0 + albedoTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, gAlbedo);
+	glActiveTexture(GL_TEXTURE0 + noiseTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, noiseTexture);
+	glActiveTexture(GL_TEXTURE0 + ssaoTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, ssaoTexture);
+
+	BeginPassTimer(SSAOPass);
+	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBuffer);
+	glViewport(0, 0, (targetWidth + 1) / 2, (targetHeight + 1) / 2);
+	glDisable(GL_DEPTH_TEST);
+	auto& ssaoShader = ShaderPool::Instance()->ssaoShader;
+	ssaoShader.bind();
+	ssaoShader.setUniform("gDepth", depthTextureUnit);
+	ssaoShader.setUniform("gNormal", normalTextureUnit);
+	ssaoShader.setUniform("noise", noiseTextureUnit);
+	glUniform3fv(ssaoShader.uniform("samples"), ssaoKernelSize, ssaoKernel[0].data());
+	ssaoShader.setUniform("radius", ssaoRadius);
+	ssaoShader.setUniform("proj", projection);
+	ssaoShader.setUniform("invProj", inverseProjection);
+	DrawFullScreenTriangle();
+	EndPassTimer();
+
+	//writes the color and the depth of the mesh to the target framebuffer, so depth testing works as in the forward path
+	BeginPassTimer(LightingPass);
+	glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	if (depthTest)
+		glEnable(GL_DEPTH_TEST);
+	auto& lightingShader = ShaderPool::Instance()->lightingShader;
+	lightingShader.bind();
+	lightingShader.setUniform("gDepth", depthTextureUnit);
+	lightingShader.setUniform("gNormal", normalTextureUnit);
+	lightingShader.setUniform("gAlbedo", albedoTextureUnit);
+	lightingShader.setUniform("ssao", ssaoTextureUnit);
+	lightingShader.setUniform("invProj", inverseProjection);
+	lightingShader.setUniform("viewportOrigin", Eigen::Vector2i(viewport[0], viewport[1]));
+	DrawFullScreenTriangle();
+	EndPassTimer();
+
+	for (int unit : { depthTextureUnit, normalTextureUnit, albedoTextureUnit, noiseTextureUnit, ssaoTextureUnit })
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void MeshRenderer::BeginPassTimer(int pass) const
+{
+	if (frameRenderCalls >= timedRenderCalls)
+		return;
+	glBeginQuery(GL_TIME_ELAPSED, timerQueries[timerQueryFrame][frameRenderCalls][pass]);
+	timerQueryUsed[timerQueryFrame][frameRenderCalls][pass] = true;
+}
+
+void MeshRenderer::EndPassTimer() const
+{
+	if (frameRenderCalls < timedRenderCalls)
+		glEndQuery(GL_TIME_ELAPSED);
+}
+
+void MeshRenderer::ReadPassTimes()
+{
+	auto& used = timerQueryUsed[timerQueryFrame];
+	auto& queries = timerQueries[timerQueryFrame];
+	bool anyUsed = false, available = true;
+	for (int call = 0; call < timedRenderCalls; ++call)
+		for (int pass = 0; pass < timedPasses; ++pass)
+			if (used[call][pass])
+			{
+				GLint result = 0;
+				glGetQueryObjectiv(queries[call][pass], GL_QUERY_RESULT_AVAILABLE, &result);
+				anyUsed = true;
+				available = available && result != 0;
+			}
+
+	//results that are not available yet are dropped, the queries are reused now
+	if (anyUsed && available)
+	{
+		RenderPassTimes times;
+		double* milliseconds[timedPasses] = { &times.geometry, &times.ssao, &times.lighting };
+		for (int call = 0; call < timedRenderCalls; ++call)
+			for (int pass = 0; pass < timedPasses; ++pass)
+				if (used[call][pass])
+				{
+					GLuint64 nanoseconds = 0;
+					glGetQueryObjectui64v(queries[call][pass], GL_QUERY_RESULT, &nanoseconds);
+					*milliseconds[pass] += nanoseconds * 1e-6;
+				}
+		passTimes = times;
+	}
+	for (int call = 0; call < timedRenderCalls; ++call)
+		for (int pass = 0; pass < timedPasses; ++pass)
+			used[call][pass] = false;
 }
 
 void MeshRenderer::RenderTextureMap(const Eigen::Matrix4f& projection, const Eigen::Vector4f& color) const
@@ -316,4 +933,35 @@ void MeshRenderer::RenderTextureMap(const Eigen::Matrix4f& projection, const Eig
 	vaoTexCoords.bind();
 	glDrawElements(GL_LINES, indexCountTexCoords, GL_UNSIGNED_INT, 0);
 	vaoTexCoords.unbind();
-}
\ No newline at end of file
+}
+
+//the query target of GL_ARB_pipeline_statistics_query, which is not part of all GL headers
+#ifndef GL_VERTEX_SHADER_INVOCATIONS_ARB
+#define GL_VERTEX_SHADER_INVOCATIONS_ARB 0x82F0
+#endif
+
+GLuint64 MeshRenderer::CountVertexShaderInvocations(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection) const
+{
+	if (indexCount == 0)
+		return 0;
+
+	GLint extensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+	bool supported = false;
+	for (GLint i = 0; i < extensions && !supported; ++i)
+		supported = std::string((const char*)glGetStringi(GL_EXTENSIONS, i)) == "GL_ARB_pipeline_statistics_query";
+	if (!supported)
+		return 0;
+
+	SetMaterialUniforms(ShaderPool::Instance()->meshShader, view, projection, false, false, Eigen::Vector4f(0.8f, 0.7f, 0.6f, 1.0f));
+
+	GLuint query;
+	glGenQueries(1, &query);
+	glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB, query);
+	Draw();
+	glEndQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB);
+	GLuint64 invocations = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &invocations);
+	glDeleteQueries(1, &query);
+	return invocations;
+}
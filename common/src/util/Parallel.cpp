@@ -0,0 +1,147 @@
+#include "util/Parallel.h"
+
+using namespace nse::util;
+
+namespace
+{
+	//set while a thread executes tasks of a batch, used to run nested batches serially
+	thread_local bool insideTask = false;
+	thread_local unsigned int currentThread = 0;
+}
+
+ThreadPool& ThreadPool::Instance()
+{
+	static ThreadPool instance;
+	return instance;
+}
+
+ThreadPool::ThreadPool()
+	: currentTask(nullptr), taskCount(0), nextTask(0), busyWorkers(0), batchId(0), stopping(false)
+{
+	StartWorkers(std::max(1u, std::thread::hardware_concurrency()) - 1);
+}
+
+ThreadPool::~ThreadPool()
+{
+	StopWorkers();
+}
+
+unsigned int ThreadPool::NumThreads() const
+{
+	return (unsigned int)workers.size() + 1;
+}
+
+void ThreadPool::SetNumThreads(unsigned int count)
+{
+	if (count == 0)
+		count = std::max(1u, std::thread::hardware_concurrency());
+
+	std::lock_guard<std::mutex> runLock(runMutex);
+	if (count == NumThreads())
+		return;
+	StopWorkers();
+	StartWorkers(count - 1);
+}
+
+void ThreadPool::StartWorkers(unsigned int count)
+{
+	unsigned long long currentBatch;
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopping = false;
+		currentBatch = batchId;
+	}
+	//new workers must not join a batch that was started before them, it does not count them in busyWorkers
+	for (unsigned int i = 0; i < count; ++i)
+		workers.emplace_back(&ThreadPool::WorkerLoop, this, i + 1, currentBatch);
+}
+
+void ThreadPool::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopping = true;
+	}
+	batchStarted.notify_all();
+	for (auto& w : workers)
+		w.join();
+	workers.clear();
+}
+
+void ThreadPool::Run(std::size_t taskCount, const TaskFunction& task)
+{
+	if (taskCount == 0)
+		return;
+
+	if (insideTask)
+	{
+		for (std::size_t i = 0; i < taskCount; ++i)
+			task(i, currentThread);
+		return;
+	}
+
+	std::lock_guard<std::mutex> runLock(runMutex);
+	if (workers.empty() || taskCount == 1)
+	{
+		insideTask = true;
+		for (std::size_t i = 0; i < taskCount; ++i)
+			task(i, 0);
+		insideTask = false;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		currentTask = &task;
+		this->taskCount = taskCount;
+		nextTask = 0;
+		busyWorkers = (unsigned int)workers.size();
+		++batchId;
+	}
+	batchStarted.notify_all();
+
+	ExecuteTasks(0, task, taskCount);
+
+	std::unique_lock<std::mutex> lock(stateMutex);
+	batchFinished.wait(lock, [this]() { return busyWorkers == 0; });
+	currentTask = nullptr;
+}
+
+void ThreadPool::WorkerLoop(unsigned int thread, unsigned long long lastBatch)
+{
+	while (true)
+	{
+		//the batch fields are only read after joining the batch under the lock
+		const TaskFunction* task;
+		std::size_t count;
+		{
+			std::unique_lock<std::mutex> lock(stateMutex);
+			batchStarted.wait(lock, [&]() { return stopping || batchId != lastBatch; });
+			if (stopping)
+				return;
+			lastBatch = batchId;
+			task = currentTask;
+			count = taskCount;
+		}
+
+		ExecuteTasks(thread, *task, count);
+
+		std::lock_guard<std::mutex> lock(stateMutex);
+		if (--busyWorkers == 0)
+			batchFinished.notify_one();
+	}
+}
+
+void ThreadPool::ExecuteTasks(unsigned int thread, const TaskFunction& task, std::size_t count)
+{
+	insideTask = true;
+	currentThread = thread;
+	while (true)
+	{
+		std::size_t i = nextTask.fetch_add(1);
+		if (i >= count)
+			break;
+		task(i, thread);
+	}
+	insideTask = false;
+}
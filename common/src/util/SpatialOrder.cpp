@@ -0,0 +1,162 @@
+#include "util/SpatialOrder.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+//bits per axis of the grid, three axes fit into 63 bits
+const int curveBits = 21;
+
+//converts cell coordinates to the transposed Hilbert index in place (Skilling's AxestoTranspose)
+static void AxesToTranspose(uint32_t x[3])
+{
+	const uint32_t m = 1u << (curveBits - 1);
+	//inverse undo
+	for (uint32_t q = m; q > 1; q >>= 1)
+	{
+		uint32_t p = q - 1;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (x[i] & q)
+				x[0] ^= p;
+			else
+			{
+				uint32_t t = (x[0] ^ x[i]) & p;
+				x[0] ^= t;
+				x[i] ^= t;
+			}
+		}
+	}
+	//Gray encode
+	for (int i = 1; i < 3; ++i)
+		x[i] ^= x[i - 1];
+	uint32_t t = 0;
+	for (uint32_t q = m; q > 1; q >>= 1)
+		if (x[2] & q)
+			t ^= q - 1;
+	for (int i = 0; i < 3; ++i)
+		x[i] ^= t;
+}
+
+//interleaves the bits of the three coordinates, the bits of x[0] are the most significant of each triple
+static uint64_t InterleaveBits(const uint32_t x[3])
+{
+	uint64_t key = 0;
+	for (int b = curveBits - 1; b >= 0; --b)
+		for (int i = 0; i < 3; ++i)
+			key = (key << 1) | ((x[i] >> b) & 1);
+	return key;
+}
+
+void ComputeCurveKeys(const std::vector<Eigen::Vector3f>& points, SpaceFillingCurve curve, std::vector<uint64_t>& keys)
+{
+	keys.resize(points.size());
+	if (points.empty())
+		return;
+
+	Eigen::Vector3f lower = points[0], upper = points[0];
+	for (auto& p : points)
+	{
+		lower = lower.cwiseMin(p);
+		upper = upper.cwiseMax(p);
+	}
+	const float maxCell = (float)((1u << curveBits) - 1);
+	float extent = std::max((upper - lower).maxCoeff(), 1e-30f);
+	float scale = maxCell / extent;
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		uint32_t x[3];
+		for (int d = 0; d < 3; ++d)
+			x[d] = (uint32_t)std::min(maxCell, std::max(0.0f, (points[i][d] - lower[d]) * scale));
+		if (curve == SpaceFillingCurve::Hilbert)
+			AxesToTranspose(x);
+		keys[i] = InterleaveBits(x);
+	}
+}
+
+bool PermuteMesh(HEMesh& m, const std::vector<unsigned int>& newVertexIndex, const std::vector<unsigned int>& newFaceIndex)
+{
+	//record the vertex attributes and the face corners in the new order
+	bool hasTexCoords = m.has_vertex_texcoords2D();
+	std::vector<HEMesh::Point> points(m.n_vertices());
+	std::vector<HEMesh::TexCoord2D> texCoords(hasTexCoords ? m.n_vertices() : 0);
+	for (auto v : m.vertices())
+	{
+		points[newVertexIndex[v.idx()]] = m.point(v);
+		if (hasTexCoords)
+			texCoords[newVertexIndex[v.idx()]] = m.texcoord2D(v);
+	}
+	std::vector<std::vector<OpenMesh::VertexHandle>> faceCorners(m.n_faces());
+	for (auto f : m.faces())
+		for (auto v : m.fv_range(f))
+			faceCorners[newFaceIndex[f.idx()]].push_back(OpenMesh::VertexHandle(newVertexIndex[v.idx()]));
+
+	//rebuild the mesh, the registered properties are kept
+	m.clean();
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		auto v = m.add_vertex(points[i]);
+		if (hasTexCoords)
+			m.set_texcoord2D(v, texCoords[i]);
+	}
+	bool complete = true;
+	for (auto& corners : faceCorners)
+		complete = m.add_face(corners).is_valid() && complete;
+	return complete;
+}
+
+//returns for every element the position of its key in the sorted order
+static std::vector<unsigned int> RankByKeys(const std::vector<uint64_t>& keys)
+{
+	std::vector<std::pair<uint64_t, unsigned int>> sorted(keys.size());
+	for (unsigned int i = 0; i < keys.size(); ++i)
+		sorted[i] = std::make_pair(keys[i], i);
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<unsigned int> rank(keys.size());
+	for (unsigned int i = 0; i < sorted.size(); ++i)
+		rank[sorted[i].second] = i;
+	return rank;
+}
+
+bool ReorderMeshAlongCurve(HEMesh& m, SpaceFillingCurve curve)
+{
+	std::vector<Eigen::Vector3f> points(m.n_vertices());
+	for (auto v : m.vertices())
+		points[v.idx()] = ToEigenVector(m.point(v));
+	std::vector<uint64_t> keys;
+	ComputeCurveKeys(points, curve, keys);
+	auto newVertexIndex = RankByKeys(keys);
+
+	//faces are placed by their centroids
+	std::vector<Eigen::Vector3f> centroids(m.n_faces(), Eigen::Vector3f::Zero());
+	for (auto f : m.faces())
+	{
+		int valence = 0;
+		for (auto v : m.fv_range(f))
+		{
+			centroids[f.idx()] += points[v.idx()];
+			++valence;
+		}
+		centroids[f.idx()] /= (float)std::max(1, valence);
+	}
+	ComputeCurveKeys(centroids, curve, keys);
+	auto newFaceIndex = RankByKeys(keys);
+
+	return PermuteMesh(m, newVertexIndex, newFaceIndex);
+}
+
+bool ShuffleMesh(HEMesh& m, unsigned int seed)
+{
+	std::mt19937 rnd(seed);
+	auto randomPermutation = [&](size_t count)
+	{
+		std::vector<unsigned int> permutation(count);
+		std::iota(permutation.begin(), permutation.end(), 0);
+		std::shuffle(permutation.begin(), permutation.end(), rnd);
+		return permutation;
+	};
+	auto newVertexIndex = randomPermutation(m.n_vertices());
+	auto newFaceIndex = randomPermutation(m.n_faces());
+	return PermuteMesh(m, newVertexIndex, newFaceIndex);
+}
@@ -3,18 +3,99 @@
 #include <stdio.h>
 #include <cstdint>
 #include <cassert>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace nse::util;
 
+namespace
+{
+	const char fileMagic[8] = { 'N', 'S', 'E', 'U', 'F', 'I', 'N', 'D' };
+	const uint32_t fileVersion = 1;
+
+	// Header of union-find files, followed by the parent indices and the ranks of all entries
+	struct FileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t policy;
+		uint64_t entries;
+	};
+
+	struct FileCloser
+	{
+		void operator()(FILE* file) const { fclose(file); }
+	};
+	typedef std::unique_ptr<FILE, FileCloser> FilePtr;
+
+	FilePtr OpenFile(const char* filename, const char* mode)
+	{
+		FilePtr file(fopen(filename, mode));
+		if (!file)
+			throw std::runtime_error(std::string("Cannot open file ") + filename);
+		return file;
+	}
+
+	// Reads count items or throws
+	template <typename T>
+	void ReadItems(FILE* file, T* data, std::size_t count)
+	{
+		if (count > 0 && fread(data, sizeof(T), count, file) != count)
+			throw std::runtime_error("Cannot read enough data from file");
+	}
+
+	// Writes count items or throws
+	template <typename T>
+	void WriteItems(FILE* file, const T* data, std::size_t count)
+	{
+		if (count > 0 && fwrite(data, sizeof(T), count, file) != count)
+			throw std::runtime_error("Cannot write data to file");
+	}
+}
+
+UnionFind::UnionFind(MergePolicy policy)
+	: policy(policy)
+{
+}
+
 void UnionFind::SaveToFile(const char* filename) const
 {
-	FILE* file = fopen(filename, "wb");
-	uint64_t entries = size();
-	fwrite(&entries, sizeof(uint64_t), 1, file);
-	fwrite(&parentIndices[0], sizeof(index_t), parentIndices.size(), file);
-	fwrite(&ranks[0], sizeof(unsigned int), ranks.size(), file);
-	fclose(file);
+	//store the root of every entry, this does not change the sets
+	std::vector<index_t> roots(parentIndices.size());
+	for (std::size_t i = 0; i < parentIndices.size(); ++i)
+	{
+		index_t current = (index_t)i;
+		while (parentIndices[current] != current)
+			current = parentIndices[current];
+		roots[i] = current;
+	}
+
+	FileHeader header;
+	std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+	header.version = fileVersion;
+	header.policy = (uint32_t)policy;
+	header.entries = size();
+
+	FilePtr file = OpenFile(filename, "wb");
+	WriteItems(file.get(), &header, 1);
+	WriteItems(file.get(), roots.data(), roots.size());
+	WriteItems(file.get(), ranks.data(), ranks.size());
+	if (fclose(file.release()) != 0)
+		throw std::runtime_error(std::string("Cannot write file ") + filename);
 }
 
 std::size_t UnionFind::size() const { return parentIndices.size(); }
@@ -22,25 +103,50 @@ std::size_t UnionFind::size() const { return parentIndices.size(); }
 // Loads the entire structure from a file. Existing data in the structure is overridden.
 void UnionFind::LoadFromFile(const char* filename)
 {
+	FilePtr file = OpenFile(filename, "rb");
+
+	char magic[sizeof(fileMagic)];
+	ReadItems(file.get(), magic, sizeof(magic));
 	uint64_t entries;
+	MergePolicy filePolicy = MergePolicy::ByRank;
+	if (std::memcmp(magic, fileMagic, sizeof(fileMagic)) == 0)
+	{
+		FileHeader header;
+		std::memcpy(header.magic, magic, sizeof(magic));
+		ReadItems(file.get(), (char*)&header + sizeof(magic), sizeof(FileHeader) - sizeof(magic));
+		if (header.version != fileVersion)
+			throw std::runtime_error(std::string("Unsupported union-find file version in ") + filename);
+		if (header.policy > (uint32_t)MergePolicy::BySize)
+			throw std::runtime_error(std::string("Invalid merge policy in ") + filename);
+		filePolicy = (MergePolicy)header.policy;
+		entries = header.entries;
+	}
+	else
+	{
+		//previous format, which starts with the number of entries
+		std::memcpy(&entries, magic, sizeof(entries));
+	}
+	if (entries > std::numeric_limits<index_t>::max())
+		throw std::runtime_error(std::string("Invalid number of entries in ") + filename);
 
-	FILE* file = fopen(filename, "rb");
-	if(fread(&entries, sizeof(uint64_t), 1, file) != 1)
-		throw std::runtime_error("Cannot read enough data from file");
-	parentIndices.resize(entries);
-	ranks.resize(entries);
-	if(fread(&parentIndices[0], sizeof(index_t), entries, file) != entries)
-		throw std::runtime_error("Cannot read enough data from file");
-	if(fread(&ranks[0], sizeof(unsigned int), entries, file) != entries)
-		throw std::runtime_error("Cannot read enough data from file");
-	fclose(file);
+	std::vector<index_t> newParents(entries);
+	std::vector<unsigned int> newRanks(entries);
+	ReadItems(file.get(), newParents.data(), newParents.size());
+	ReadItems(file.get(), newRanks.data(), newRanks.size());
+	for (auto parent : newParents)
+		if (parent >= entries)
+			throw std::runtime_error(std::string("Invalid parent index in ") + filename);
+
+	policy = filePolicy;
+	parentIndices.swap(newParents);
+	ranks.swap(newRanks);
 }
 
 // Adds an item to the structure
 void UnionFind::AddItem()
 {
 	parentIndices.push_back((index_t)parentIndices.size());
-	ranks.push_back(0);
+	ranks.push_back(policy == MergePolicy::BySize ? 1 : 0);
 }
 
 void UnionFind::AddItems(std::size_t count)
@@ -49,7 +155,7 @@ void UnionFind::AddItems(std::size_t count)
 	parentIndices.resize(parentIndices.size() + count);
 	for (index_t i = static_cast<index_t>(oldCount); i < parentIndices.size(); ++i)
 		parentIndices[i] = i;
-	ranks.resize(ranks.size() + count);
+	ranks.resize(ranks.size() + count, policy == MergePolicy::BySize ? 1 : 0);
 }
 
 void UnionFind::Clear()
@@ -88,6 +194,15 @@ UnionFind::index_t UnionFind::Merge(index_t i1, index_t i2)
 	if (rep1 == rep2)
 		return rep1;
 
+	if (policy == MergePolicy::BySize)
+	{
+		if (ranks[rep1] < ranks[rep2])
+			std::swap(rep1, rep2);
+		ranks[rep1] += ranks[rep2];
+		ConcreteMerge(rep1, rep2);
+		return rep1;
+	}
+
 	//Union by rank
 	unsigned int rank1 = ranks[rep1];
 	unsigned int rank2 = ranks[rep2];
@@ -122,12 +237,102 @@ void UnionFind::MergeWithPredefinedRoot(index_t newRoot, index_t i)
 	unsigned int rank1 = ranks[newRoot];
 	unsigned int rank2 = ranks[rep2];
 
-	if (rank1 == rank2)
+	if (policy == MergePolicy::BySize)
+		ranks[newRoot] += rank2;
+	else if (rank1 == rank2)
 		++ranks[newRoot];
-	ConcreteMerge(newRoot, i);
+	ConcreteMerge(newRoot, rep2);
 }
 
 void UnionFind::ConcreteMerge(index_t newRoot, index_t child)
 {
 	parentIndices[child] = newRoot;
-}
\ No newline at end of file
+}
+
+MappedUnionFind::MappedUnionFind()
+	: mapping(nullptr), mappingSize(0), entries(0), parentIndices(nullptr)
+#ifdef _WIN32
+	, fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedUnionFind::~MappedUnionFind()
+{
+	Close();
+}
+
+void MappedUnionFind::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		throw std::runtime_error(std::string("Cannot open file ") + filename);
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(FileHeader))
+	{
+		Close();
+		throw std::runtime_error(std::string("Not a union-find file: ") + filename);
+	}
+	mappingSize = (std::size_t)fileSize.QuadPart;
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle != nullptr)
+		mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (mapping == nullptr)
+	{
+		Close();
+		throw std::runtime_error(std::string("Cannot map file ") + filename);
+	}
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error(std::string("Cannot open file ") + filename);
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(FileHeader))
+	{
+		close(fd);
+		throw std::runtime_error(std::string("Not a union-find file: ") + filename);
+	}
+	mappingSize = (std::size_t)fileStat.st_size;
+	void* data = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+	//the mapping stays valid after closing the descriptor
+	close(fd);
+	if (data == MAP_FAILED)
+		throw std::runtime_error(std::string("Cannot map file ") + filename);
+	mapping = data;
+#endif
+
+	FileHeader header;
+	std::memcpy(&header, mapping, sizeof(header));
+	if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || header.version != fileVersion
+		|| header.entries > (mappingSize - sizeof(FileHeader)) / (sizeof(index_t) + sizeof(unsigned int)))
+	{
+		Close();
+		throw std::runtime_error(std::string("Not a union-find file: ") + filename);
+	}
+	entries = header.entries;
+	parentIndices = reinterpret_cast<const index_t*>(static_cast<const char*>(mapping) + sizeof(FileHeader));
+}
+
+void MappedUnionFind::Close()
+{
+#ifdef _WIN32
+	if (mapping)
+		UnmapViewOfFile(mapping);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (mapping)
+		munmap(const_cast<void*>(mapping), mappingSize);
+#endif
+	mapping = nullptr;
+	mappingSize = 0;
+	entries = 0;
+	parentIndices = nullptr;
+}
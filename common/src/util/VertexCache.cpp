@@ -0,0 +1,274 @@
+#include "util/VertexCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <Eigen/Geometry>
+
+//parameters of the vertex score from Forsyth's article
+const int forsythCacheSize = 32;
+const float lastTriangleScore = 0.75f;
+const float cacheDecayPower = 1.5f;
+const float valenceBoostScale = 2.0f;
+const float valenceBoostPower = 0.5f;
+//the valence boost is tabulated up to this number of remaining triangles
+const unsigned int maxTabulatedValence = 64;
+
+VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStatistics stats;
+	if (indices.empty())
+		return stats;
+
+	//a vertex is in the FIFO cache if less than cacheSize misses happened since it was inserted
+	std::vector<long long> insertedAt(vertexCount, -1);
+	long long misses = 0;
+	size_t referencedVertices = 0;
+	for (auto v : indices)
+	{
+		if (insertedAt[v] < 0)
+			++referencedVertices;
+		if (insertedAt[v] < 0 || misses - insertedAt[v] >= cacheSize)
+			insertedAt[v] = misses++;
+	}
+	stats.acmr = (double)misses / (indices.size() / 3);
+	stats.atvr = (double)misses / referencedVertices;
+	return stats;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>* triangleData)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	float cacheScores[forsythCacheSize];
+	for (int i = 0; i < forsythCacheSize; ++i)
+		cacheScores[i] = i < 3 ? lastTriangleScore : std::pow(1.0f - (i - 3) / (float)(forsythCacheSize - 3), cacheDecayPower);
+	float valenceScores[maxTabulatedValence + 1];
+	valenceScores[0] = 0;
+	for (unsigned int i = 1; i <= maxTabulatedValence; ++i)
+		valenceScores[i] = valenceBoostScale * std::pow((float)i, -valenceBoostPower);
+
+	//the remaining triangles of vertex v are triangles[offsets[v]] ... triangles[offsets[v] + remaining[v] - 1]
+	std::vector<uint32_t> offsets(vertexCount + 1, 0), remaining(vertexCount, 0);
+	for (auto v : indices)
+		++remaining[v];
+	for (size_t v = 0; v < vertexCount; ++v)
+		offsets[v + 1] = offsets[v] + remaining[v];
+	std::vector<uint32_t> triangles(indices.size());
+	{
+		std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i)
+			triangles[next[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	auto vertexScore = [&](uint32_t v)
+	{
+		//vertices without remaining triangles do not contribute
+		if (remaining[v] == 0)
+			return -1.0f;
+		float score = cachePosition[v] >= 0 ? cacheScores[cachePosition[v]] : 0.0f;
+		score += remaining[v] <= maxTabulatedValence ? valenceScores[remaining[v]] : valenceBoostScale * std::pow((float)remaining[v], -valenceBoostPower);
+		return score;
+	};
+
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v)
+		vertexScores[v] = vertexScore((uint32_t)v);
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t)
+		triangleScores[t] = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+
+	std::vector<unsigned char> emitted(triangleCount, 0);
+	std::vector<uint32_t> result, resultData;
+	result.reserve(indices.size());
+	if (triangleData)
+		resultData.reserve(triangleCount);
+	std::vector<uint32_t> cache, newCache, touched;
+	cache.reserve(forsythCacheSize + 3);
+	newCache.reserve(forsythCacheSize + 3);
+
+	size_t best = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+	size_t nextUnemitted = 0;
+	for (size_t step = 0; step < triangleCount; ++step)
+	{
+		//no triangle touches the cache, continue with the next triangle in input order
+		if (best == triangleCount)
+		{
+			while (emitted[nextUnemitted])
+				++nextUnemitted;
+			best = nextUnemitted;
+		}
+
+		const uint32_t* corners = &indices[3 * best];
+		emitted[best] = 1;
+		result.insert(result.end(), corners, corners + 3);
+		if (triangleData)
+			resultData.push_back((*triangleData)[best]);
+
+		for (int c = 0; c < 3; ++c)
+		{
+			uint32_t v = corners[c];
+			uint32_t* list = &triangles[offsets[v]];
+			uint32_t* last = list + remaining[v] - 1;
+			*std::find(list, last + 1, (uint32_t)best) = *last;
+			--remaining[v];
+		}
+
+		//the corners move to the front of the LRU cache
+		newCache.clear();
+		for (int c = 0; c < 3; ++c)
+			if (std::find(newCache.begin(), newCache.end(), corners[c]) == newCache.end())
+				newCache.push_back(corners[c]);
+		for (auto v : cache)
+			if (v != corners[0] && v != corners[1] && v != corners[2])
+				newCache.push_back(v);
+		touched.assign(newCache.begin(), newCache.end());
+		for (size_t i = forsythCacheSize; i < newCache.size(); ++i)
+			cachePosition[newCache[i]] = -1;
+		if (newCache.size() > (size_t)forsythCacheSize)
+			newCache.resize(forsythCacheSize);
+		for (size_t i = 0; i < newCache.size(); ++i)
+			cachePosition[newCache[i]] = (int)i;
+		std::swap(cache, newCache);
+
+		//update the scores of the triangles around the touched vertices and pick the best one
+		for (auto v : touched)
+			vertexScores[v] = vertexScore(v);
+		best = triangleCount;
+		float bestScore = -1;
+		for (auto v : touched)
+			for (uint32_t i = offsets[v]; i < offsets[v] + remaining[v]; ++i)
+			{
+				uint32_t t = triangles[i];
+				float score = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+				triangleScores[t] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					best = t;
+				}
+			}
+	}
+	indices.swap(result);
+	if (triangleData)
+		triangleData->swap(resultData);
+}
+
+size_t OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Eigen::Vector3f>& positions, float threshold,
+	std::vector<uint32_t>* triangleData)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return 0;
+
+	//simulates the FIFO cache of AnalyzeVertexCache, restarting it at clusterStart
+	const unsigned int cacheSize = 16;
+	std::vector<long long> insertedAt(positions.size(), -1);
+	long long misses = 0;
+	auto triangleMisses = [&](size_t t)
+	{
+		int triangleMisses = 0;
+		for (int c = 0; c < 3; ++c)
+		{
+			uint32_t v = indices[3 * t + c];
+			if (insertedAt[v] < 0 || misses - insertedAt[v] >= cacheSize)
+			{
+				insertedAt[v] = misses++;
+				++triangleMisses;
+			}
+		}
+		return triangleMisses;
+	};
+	auto resetCache = [&]()
+	{
+		//moving the clock forward invalidates all entries
+		misses += cacheSize;
+	};
+
+	//hard boundaries are triangles whose corners all miss the cache
+	std::vector<size_t> hardBoundaries, missesPerTriangle(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		missesPerTriangle[t] = triangleMisses(t);
+		if (t == 0 || missesPerTriangle[t] == 3)
+			hardBoundaries.push_back(t);
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	//soft boundaries split hard clusters where the cluster has reached a cache efficiency close to the whole run
+	std::vector<size_t> clusterStarts;
+	for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+	{
+		size_t begin = hardBoundaries[h], end = hardBoundaries[h + 1];
+		size_t hardMisses = 0;
+		for (size_t t = begin; t < end; ++t)
+			hardMisses += missesPerTriangle[t];
+		double maxAcmr = threshold * (double)hardMisses / (end - begin);
+
+		size_t start = begin, clusterMisses = 0;
+		clusterStarts.push_back(start);
+		resetCache();
+		for (size_t t = begin; t < end; ++t)
+		{
+			clusterMisses += triangleMisses(t);
+			if (t + 1 < end && (double)clusterMisses / (t - start + 1) <= maxAcmr)
+			{
+				start = t + 1;
+				clusterMisses = 0;
+				clusterStarts.push_back(start);
+				resetCache();
+			}
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+	size_t clusterCount = clusterStarts.size() - 1;
+
+	//clusters that face away from the center of the mesh are likely in front and are drawn first
+	std::vector<Eigen::Vector3f> centroids(clusterCount, Eigen::Vector3f::Zero()), normals(clusterCount, Eigen::Vector3f::Zero());
+	std::vector<float> areas(clusterCount, 0);
+	Eigen::Vector3f meshCentroid = Eigen::Vector3f::Zero();
+	float meshArea = 0;
+	for (size_t k = 0; k < clusterCount; ++k)
+	{
+		for (size_t t = clusterStarts[k]; t < clusterStarts[k + 1]; ++t)
+		{
+			auto& p0 = positions[indices[3 * t]];
+			auto& p1 = positions[indices[3 * t + 1]];
+			auto& p2 = positions[indices[3 * t + 2]];
+			Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
+			float area = n.norm();
+			centroids[k] += area * (p0 + p1 + p2) / 3;
+			normals[k] += n;
+			areas[k] += area;
+		}
+		meshCentroid += centroids[k];
+		meshArea += areas[k];
+		if (areas[k] > 0)
+			centroids[k] /= areas[k];
+	}
+	if (meshArea > 0)
+		meshCentroid /= meshArea;
+
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t k = 0; k < clusterCount; ++k)
+		sortKeys[k] = (centroids[k] - meshCentroid).dot(normals[k].normalized());
+	std::vector<size_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result, resultData;
+	result.reserve(indices.size());
+	for (auto k : order)
+	{
+		result.insert(result.end(), indices.begin() + 3 * clusterStarts[k], indices.begin() + 3 * clusterStarts[k + 1]);
+		if (triangleData)
+			resultData.insert(resultData.end(), triangleData->begin() + clusterStarts[k], triangleData->begin() + clusterStarts[k + 1]);
+	}
+	indices.swap(result);
+	if (triangleData)
+		triangleData->swap(resultData);
+	return clusterCount;
+}
@@ -0,0 +1,76 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include "util/OpenMeshUtils.h"
+
+//The benchmarks print their measurements to the console and validate their results. A failed check is printed to
+//std::cerr and makes the benchmark return false.
+
+//compares the run time and results of ComputeSurfaceArea and ComputeVolume with the
+//fused parallel ComputeMeshIntegrals and prints them to the console
+bool BenchmarkMeshIntegrals(const HEMesh& m);
+
+//runs the uniform Laplacian smoothing on copies of m with the circulator based reference implementation and the
+//flat array implementation and prints the iterations per second and the largest position difference.
+//Then measures the thread scaling of uniform and cotangent smoothing with the Jacobi and the colored Gauss-Seidel
+//scheme and checks that the results do not depend on the number of threads.
+bool BenchmarkSmoothing(const HEMesh& m, float lamda, unsigned int iterations);
+
+//smooths copies of m with one implicit cotangent smoothing step with lamda * iterations and with explicit cotangent
+//smoothing with lamda until the same mean Laplacian length is reached and prints the run times
+bool BenchmarkImplicitSmoothing(const HEMesh& m, float lamda, unsigned int iterations);
+
+//compares the run time of the angle based cotangent weights with the cached weights of LaplacianMatrix for different
+//numbers of threads and the time of incremental updates. Fails if the weights differ from the angle based weights by
+//more than 1e-3 relative to max(1, |w|) on interior edges without angles within 1 degree of 0 or 180 degrees.
+bool BenchmarkCotangentWeights(const HEMesh& m);
+
+//smooths m with plain and with Chebyshev accelerated Jacobi sweeps until the residual has dropped to tolerance
+//times its initial value and prints the number of sweeps and the run times
+bool BenchmarkSmoothingToTolerance(const HEMesh& m, float lamda, double tolerance);
+
+//extracts the shells of a mesh made of many copies of m with the flood fill and the union-find implementation,
+//prints the run times for different numbers of threads and checks that both give the same shell ids
+bool BenchmarkShellExtraction(const HEMesh& m);
+
+//measures the merge throughput of the serial union-find with both merge policies and of the concurrent union-find
+//for different numbers of threads, runs a stress test with many threads merging few sets and measures saving,
+//loading and memory-mapping a union-find file. All results are compared to a serial reference.
+bool BenchmarkUnionFind();
+
+//compares the hash map and the flat array sample_set on the face handles of m (inserting all faces, then sampling
+//and removing until the set is empty) and in ExtractTriStrips and the flood fill shell extraction, which is compared
+//to ExtractShells. Fails if the set types give different strips or shells.
+bool BenchmarkSampleSets(const HEMesh& m, unsigned int nTrials);
+
+//extracts triangle strips from a triangulated copy of m with random trials and with degree priority seeds and
+//prints the number of strips, the average strip length and the run time of both modes. Then measures the thread
+//scaling of the random trials mode for different numbers of trials and checks that the strips do not change.
+bool BenchmarkStripification(const HEMesh& m, unsigned int nTrials);
+
+//prints ACMR and ATVR of the triangle list of m in mesh order, after OptimizeVertexCache and after OptimizeOverdraw
+//for FIFO caches of 16 and 32 entries, together with the run times of the optimizations
+bool BenchmarkVertexCache(const HEMesh& m);
+
+//compares a randomly shuffled copy of m with copies reordered along the Morton and the Hilbert curve. Prints the
+//run times of SmoothUniformLaplacian and ComputeSurfaceArea together with the misses of their position and
+//halfedge loads. The misses are not measured on the hardware, they come from a software simulation of a 32 KB, 8-way
+//L1 data cache with 64 byte lines.
+bool BenchmarkSpatialOrder(const HEMesh& m, float lamda, unsigned int iterations);
+
+//builds a MeshRenderer for copies of m with at least 5 million vertices and prints the time and the uploaded bytes
+//of Update and UpdateGeometry without changes, after moving 1 % of the vertices, after smoothing all vertices and
+//after InvalidateBuffers. Requires a current OpenGL context.
+bool BenchmarkRendererUpdates(const HEMesh& m, float lamda);
+
+//uploads copies of m with at least 5 million vertices in every VertexFormat and prints the GPU memory of the mesh
+//and the time of a complete upload. Requires a current OpenGL context.
+bool BenchmarkVertexFormats(const HEMesh& m);
+
+//computes the vertex normals of copies of m with at least 5 million vertices by circulating every vertex
+//(calc_vertex_normal_correct) and with the ComputeVertexNormals kernel for different numbers of threads. Prints the
+//run times, the largest difference to the circulation and whether the kernel gives the same result for all threads.
+bool BenchmarkVertexNormals(const HEMesh& m);
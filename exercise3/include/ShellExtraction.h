@@ -5,9 +5,19 @@
 #pragma once
 
 #include "util/OpenMeshUtils.h"
+#include "sample_set.h"
 
 //Finds the connected components in the mesh. Writes the non-negative shell index into perFaceShellIndex
 //and returns the number of shells.
+//The faces of every interior edge are merged in parallel with a concurrent union-find, the shells are numbered
+//in the order of their first face.
 unsigned int ExtractShells(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex);
-void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle seed, unsigned int shellId);
+//Finds the connected components with a flood fill from every unlabeled face, gives the same result as ExtractShells
+//FaceSet is the queue of the flood fill, sample_set<OpenMesh::FaceHandle> (flat array) or
+//hashed_sample_set<OpenMesh::FaceHandle>.
+template <typename FaceSet = sample_set<OpenMesh::FaceHandle>>
+unsigned int ExtractShellsFloodFill(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex);
+//Labels all faces of the shell of seed, connectedSet is used as queue
+template <typename FaceSet>
+void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle seed, unsigned int shellId, FaceSet& connectedSet);
 std::vector<OpenMesh::FaceHandle> getConnectedFaces(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle faceHandle);
\ No newline at end of file
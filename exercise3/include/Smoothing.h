@@ -5,13 +5,104 @@
 #pragma once
 
 #include "util/OpenMeshUtils.h"
+#include "util/MeshAdjacency.h"
+#include "util/LaplacianMatrix.h"
+#include <Eigen/Sparse>
+
+//Order in which the vertices are updated within one smoothing iteration.
+//Both schemes run in parallel and give the same result for any number of threads.
+enum class SmoothingScheme
+{
+	//all vertices are moved based on the positions of the previous iteration
+	Jacobi,
+	//the vertices are partitioned into independent sets by a graph coloring, the sets are moved one after
+	//another and later sets already see the new positions of earlier ones. Converges in fewer iterations.
+	ColoredGaussSeidel
+};
 
 //Updates the vertex positions by Laplacian smoothing
-void SmoothUniformLaplacian(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty);
+//The connectivity and positions are copied to flat arrays once, all iterations run on these arrays
+void SmoothUniformLaplacian(HEMesh& m, float lamda, unsigned int iterations, SmoothingScheme scheme = SmoothingScheme::Jacobi);
+//Returns the position of vertex v after one step of uniform Laplacian smoothing, boundary vertices are not moved
+Eigen::Vector3f UniformLaplacianStep(const MeshAdjacency& adjacency, const std::vector<Eigen::Vector3f>& positions, float lamda, size_t v);
+//Returns the mean distance of the interior vertices to the centers of gravity of their neighbors
+double UniformLaplacianResidual(const MeshAdjacency& adjacency, const std::vector<Eigen::Vector3f>& positions);
+
+//Acceleration of the smoothing iterations in SmoothUniformLaplacianToTolerance
+enum class SmoothingAcceleration
+{
+	//plain Jacobi sweeps
+	None,
+	//Chebyshev semi-iterative acceleration of the Jacobi sweeps. The spectral radius of the Jacobi update is estimated
+	//from the decay of the residual during the first sweeps.
+	Chebyshev
+};
+
+//Statistics of SmoothUniformLaplacianToTolerance
+struct SmoothingStatistics
+{
+	unsigned int sweeps = 0;
+	double initialResidual = 0, finalResidual = 0;
+	bool converged = false;
+};
+
+//Updates the vertex positions by uniform Laplacian smoothing until the residual (see UniformLaplacianResidual) has
+//dropped to tolerance times its initial value or maxSweeps sweeps were performed. The residual of each sweep is
+//computed in the same pass as the update.
+SmoothingStatistics SmoothUniformLaplacianToTolerance(HEMesh& m, float lamda, double tolerance, unsigned int maxSweeps, SmoothingAcceleration acceleration);
+//Smooths the positions in place, see above
+SmoothingStatistics SmoothUniformLaplacianToTolerance(const MeshAdjacency& adjacency, std::vector<Eigen::Vector3f>& positions, float lamda, double tolerance, unsigned int maxSweeps, SmoothingAcceleration acceleration);
+
+//Updates the vertex positions by Laplacian smoothing using vertex circulators and a vertex property for the centers of gravity
+//This is the reference implementation for SmoothUniformLaplacian
+void SmoothUniformLaplacianCirculators(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty);
 //Updates the vertex positions using cotangent discretization of the Laplacian
-void SmoothCotangentLaplacian(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double> atheta, OpenMesh::EPropHandleT<double> btheta);
+//The weights are computed once for the positions at the beginning, laplacian caches them across calls
+void SmoothCotangentLaplacian(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, LaplacianMatrix& laplacian, SmoothingScheme scheme = SmoothingScheme::Jacobi);
+
+//Implicit (backward Euler) smoothing with the cotangent Laplacian D^-1 C - I, where C holds the edge weights of a
+//LaplacianMatrix and D their row sums. A step x' = x + lamda (D^-1 C - I) x' solves ((1 + lamda) D - lamda C) x' = D x,
+//which is symmetric, so the system is factorized once by a sparse Cholesky (LDLT) decomposition and reused for all
+//steps and all three coordinates.
+//Boundary vertices and vertices without positive weight sum stay fixed. The system has the sparsity pattern of
+//the Laplace matrix, the couplings to fixed vertices are moved to the right hand side.
+class ImplicitCotangentSmoothing
+{
+public:
+	//computes and factorizes the system for the weights of laplacian, returns false if the factorization fails
+	bool Factorize(const HEMesh& m, const LaplacianMatrix& laplacian, float lamda);
+
+	//performs the given number of implicit smoothing steps with the cached factorization
+	void Smooth(HEMesh& m, unsigned int steps);
+
+	//returns true if the system was factorized for lamda and the vertices of m are still at the positions of the last
+	//Factorize or Smooth call, then further steps can reuse the factorization (with the weights of the first step)
+	bool IsFactorizedFor(const HEMesh& m, float lamda) const;
+
+private:
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+	//row sums of the weights of the free vertices, 1 for fixed vertices
+	Eigen::VectorXd diagonal;
+	//lamda times the weights between free (rows) and fixed (columns) vertices
+	Eigen::SparseMatrix<double> fixedCoupling;
+	std::vector<unsigned char> fixed;
+	float factorizedLamda = 0;
+	size_t numFaces = 0;
+	//vertex positions after the last Factorize or Smooth call
+	std::vector<OpenMesh::Vec3f> positions;
+};
+
+//Updates the vertex positions with implicit smoothing using the cotangent discretization of the Laplacian
+//The system in smoothing is only recomputed if lamda or the mesh changed since its last step, then the weights are
+//updated in laplacian, which keeps the sparsity pattern across calls
+void SmoothCotangentLaplacianImplicit(HEMesh& m, float lamda, unsigned int steps, LaplacianMatrix& laplacian, ImplicitCotangentSmoothing& smoothing);
+
 void ComputeCOG(HEMesh& m, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::VertexHandle vertexHandle);
-void ComputeCOGCotangent(HEMesh &m,  OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double> atheta, OpenMesh::EPropHandleT<double> btheta, OpenMesh::VertexHandle vertexHandle);
-void CotanWeight(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double>atheta, OpenMesh::EPropHandleT<double>btheta);
+void ComputeCOGCotangent(HEMesh &m,  OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::VertexHandle vertexHandle);
+//Updates the cotangent weights of laplacian and stores them in eWeights
+void CotanWeight(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, LaplacianMatrix& laplacian);
+//Computes the cotangent weights from the angles, which are also stored in degrees in atheta and btheta
+//This is the reference implementation for the cotangent weights of LaplacianMatrix
+void CotanWeightFromAngles(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double>atheta, OpenMesh::EPropHandleT<double>btheta);
 void SetNewPosition(HEMesh& m, float lamda, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::VertexHandle vertexHandle);
 void AddNoise(HEMesh& m);
\ No newline at end of file
@@ -7,9 +7,27 @@
 #include "util/OpenMeshUtils.h"
 #include "sample_set.h"
 
+//Strategy for choosing the seed faces of the strips
+enum class StripificationMode
+{
+	//grows strips from nTrials random seeds and keeps the longest one. The trials are evaluated in parallel,
+	//the result does not depend on the number of threads.
+	RandomTrials,
+	//seeds each strip at an unassigned face with the fewest unassigned neighbors, taken from a bucket queue.
+	//The three possible directions through the seed are only counted, the longest one is then grown in place.
+	//A strip continues with a swap (one additional vertex) if the alternating turn is blocked.
+	DegreePriority
+};
+
 //Extracts triangle strips from the mesh, writes the Strip Id of each face in 
-//perFaceStripIdProperty, and returns the number of strips.
-unsigned int ExtractTriStrips(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials);
-sample_set<OpenMesh::FaceHandle> calculateTriangleStrip (HEMesh& mesh,OpenMesh::FPropHandleT<int> perFaceStripIdProperty, OpenMesh::FaceHandle seed_pointer);
+//perFaceStripIdProperty, and returns the number of strips. nTrials is ignored in DegreePriority mode.
+//FaceSet is the set of faces used by the random trials, sample_set<OpenMesh::FaceHandle> (flat array) or
+//hashed_sample_set<OpenMesh::FaceHandle>. Both give the same strips.
+template <typename FaceSet = sample_set<OpenMesh::FaceHandle>>
+unsigned int ExtractTriStrips(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials, StripificationMode mode = StripificationMode::RandomTrials);
+//Computes the strip through seed_pointer that only contains unassigned faces. The faces are written to triangle_strip,
+//which is cleared first, such that its memory can be reused for many seeds.
+template <typename FaceSet>
+void calculateTriangleStrip (HEMesh& mesh,OpenMesh::FPropHandleT<int> perFaceStripIdProperty, OpenMesh::FaceHandle seed_pointer, FaceSet& triangle_strip);
 OpenMesh::HalfedgeHandle goForwards(HEMesh& mesh, OpenMesh::HalfedgeHandle hi, bool parity);
 OpenMesh::HalfedgeHandle goBackwards(HEMesh& mesh, OpenMesh::HalfedgeHandle hi, bool parity);
@@ -7,6 +7,8 @@
 #include <gui/AbstractViewer.h>
 #include <util/OpenMeshUtils.h>
 
+#include "Smoothing.h"
+
 class Viewer : public nse::gui::AbstractViewer
 {
 public:
@@ -20,12 +22,25 @@ private:
 
 	void ColorMeshFromIds();
 
+	//renders the mesh as triangle list in mesh and in vertex cache order and as triangle strips and prints the index
+	//counts and vertex shader invocations
+	void CompareStripRendering();
+
 	bool hasColors = false;
+	//true if faceIdProperty contains strip ids of the current mesh
+	bool hasStrips = false;
 
 	nanogui::ComboBox* shadingBtn;
+	nanogui::ComboBox* triangleOrderBtn;
+	nanogui::ComboBox* vertexFormatBtn;
+	nanogui::ComboBox* renderPathBtn;
 	unsigned int smoothingIterations;
 	nanogui::Slider* sldSmoothingStrength;
+	nanogui::ComboBox* smoothingSchemeBtn;
+	nanogui::Slider* sldSmoothingTolerance;
 	unsigned int stripificationTrials;
+	nanogui::ComboBox* stripificationModeBtn;
+	nanogui::CheckBox* chkRenderStrips;
 
 	HEMesh polymesh;
 	MeshRenderer renderer;
@@ -33,6 +48,8 @@ private:
 	OpenMesh::FPropHandleT<int> faceIdProperty;
 	OpenMesh::FPropHandleT<Eigen::Vector4f> faceColorProperty;
 	OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty;
-    OpenMesh::EPropHandleT<double> eWeights, atheta, btheta;
+    OpenMesh::EPropHandleT<double> eWeights;
+	LaplacianMatrix laplacian;
+	ImplicitCotangentSmoothing implicitSmoothing;
 
 };
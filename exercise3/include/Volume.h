@@ -11,4 +11,5 @@
 //method IS restricted to closed triangle meshes
 float ComputeVolume(const HEMesh& m);
 
-float SignedVolumeOfTriangle(std::vector<OpenMesh::Vec3f>& points);
\ No newline at end of file
+//returns the signed volume of the tetrahedron spanned by the origin and the triangle (p0, p1, p2)
+float SignedVolumeOfTriangle(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const OpenMesh::Vec3f& p2);
\ No newline at end of file
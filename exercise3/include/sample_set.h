@@ -7,6 +7,10 @@
 #include <vector>
 #include <unordered_map>
 #include <random>
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <OpenMesh/Core/Mesh/Handles.hh>
 
 
 /*
@@ -28,11 +32,14 @@ my_set.remove(2);
 
 int rand_elem2 = my_set.sample(eng); //1 or 6
 
+For OpenMesh handles, sample_set uses a flat array indexed by the handle index instead of a hash map.
+hashed_sample_set always uses the hash map.
+
 */
 
 
 template <typename T>
-struct sample_set
+struct hashed_sample_set
 {
 	
 	typedef int element_index;
@@ -41,7 +48,7 @@ struct sample_set
 		
 	
 	//create empty set
-	sample_set(){}
+	hashed_sample_set(){}
 	
 	//reserve memory for n elements
 	void reserve(size_t n)
@@ -106,4 +113,118 @@ struct sample_set
 		return elements.empty();
 	}
 
+	//returns true if elem is in the set
+	bool contains(const T& elem) const
+	{
+		return index_lut.find(elem) != index_lut.end();
+	}
+
+	//removes all elements
+	void clear()
+	{
+		elements.clear();
+		index_lut.clear();
+	}
+
+};
+
+//a set data structure for dense indices like OpenMesh handles. A flat array that maps every index to the position
+//of the element replaces the hash map. The array grows to the largest inserted index and is kept by clear().
+template <typename T>
+struct dense_sample_set
+{
+
+	typedef int element_index;
+	std::vector<T> elements;
+	//position of every index in elements, -1 for indices that are not in the set
+	std::vector<element_index> index_lut;
+
+
+	//create empty set
+	dense_sample_set(){}
+
+	//reserve memory for the indices 0 .. n-1
+	void reserve(size_t n)
+	{
+		elements.reserve(n);
+		if (index_lut.size() < n)
+			index_lut.resize(n, -1);
+	}
+
+	//insert element elem into set
+	void insert(const T& elem)
+	{
+		assert(elem.idx() >= 0);
+		size_t key = (size_t)elem.idx();
+		if (key >= index_lut.size())
+			index_lut.resize(std::max(key + 1, 2 * index_lut.size()), -1);
+		//guard against duplicates
+		if (index_lut[key] < 0)
+		{
+			index_lut[key] = (element_index)elements.size();
+			elements.push_back(elem);
+		}
+	}
+
+	//remove element elem from set
+	bool remove(const T& elem)
+	{
+		if (!contains(elem))
+			return false;
+
+		element_index i = index_lut[elem.idx()];
+		index_lut[elem.idx()] = -1;
+		elements[i] = elements.back();
+		elements.pop_back();
+		if (unsigned(i) < elements.size())
+			index_lut[elements[i].idx()] = i;
+		return true;
+	}
+
+	//draw a sample from set
+	template <typename Engine>
+	const T& sample(Engine& eng)
+	{
+		int b = (element_index)(elements.size()-1);
+		std::uniform_int_distribution<int> uniform_dist(0,b);
+		element_index idx = uniform_dist(eng);
+		return elements[idx];
+	}
+
+	//returns number of elements in set
+	size_t size() const
+	{
+		return elements.size();
+	}
+
+	//returns true if set is empty
+	bool empty() const
+	{
+		return elements.empty();
+	}
+
+	//returns true if elem is in the set
+	bool contains(const T& elem) const
+	{
+		return elem.idx() >= 0 && (size_t)elem.idx() < index_lut.size() && index_lut[elem.idx()] >= 0;
+	}
+
+	//removes all elements in O(size), the index array is kept
+	void clear()
+	{
+		for (auto& e : elements)
+			index_lut[e.idx()] = -1;
+		elements.clear();
+	}
+
+};
+
+template <typename T, typename Enable = void>
+struct sample_set : hashed_sample_set<T>
+{
+};
+
+template <typename T>
+struct sample_set<T, typename std::enable_if<std::is_base_of<OpenMesh::BaseHandle, T>::value>::type> : dense_sample_set<T>
+{
 };
@@ -0,0 +1,964 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <util/MeshAdjacency.h>
+#include <util/MeshIntegrals.h>
+#include <util/MeshNormals.h>
+#include <util/ConcurrentUnionFind.h>
+#include <util/UnionFind.h>
+#include <util/VertexCache.h>
+#include <util/SpatialOrder.h>
+#include <util/Parallel.h>
+#include <util/Benchmark.h>
+
+#include "ShellExtraction.h"
+#include "Smoothing.h"
+#include "Stripification.h"
+#include "SurfaceArea.h"
+#include "Volume.h"
+
+using nse::util::MillisecondsSince;
+using nse::util::MeasureThreadScaling;
+using nse::util::CheckResult;
+using nse::util::RelativelyClose;
+
+bool BenchmarkMeshIntegrals(const HEMesh& m)
+{
+	std::cout << "Mesh integrals for " << m.n_faces() << " faces using " << nse::util::NumThreads() << " threads .." << std::endl;
+
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	float area = ComputeSurfaceArea(m);
+	double areaTime = MillisecondsSince(timeStart);
+
+	timeStart = std::chrono::high_resolution_clock::now();
+	float volume = ComputeVolume(m);
+	double volumeTime = MillisecondsSince(timeStart);
+
+	timeStart = std::chrono::high_resolution_clock::now();
+	MeshIntegrals integrals = ComputeMeshIntegrals(m);
+	double integralsTime = MillisecondsSince(timeStart);
+
+	std::cout << std::setprecision(10);
+	std::cout << "ComputeSurfaceArea: " << area << " (" << areaTime << " ms)" << std::endl;
+	std::cout << "ComputeVolume: " << volume << " (" << volumeTime << " ms)" << std::endl;
+	std::cout << "ComputeMeshIntegrals: area " << integrals.area << ", volume " << integrals.volume << " (" << integralsTime << " ms)" << std::endl;
+	std::cout << "Centroid: " << integrals.centroid.transpose() << std::endl;
+	std::cout << "Inertia tensor:" << std::endl << integrals.inertia << std::endl;
+	std::cout << std::setprecision(6);
+
+	//the fused integrals sum in a different order than the separate functions, their volumes only agree for closed meshes
+	bool closed = true;
+	for (auto h : m.halfedges())
+		closed = closed && !m.is_boundary(h);
+	bool passed = CheckResult(RelativelyClose(integrals.area, area, 1e-4), "ComputeMeshIntegrals area matches ComputeSurfaceArea");
+	if (closed)
+		passed = CheckResult(RelativelyClose(integrals.volume, volume, 1e-4), "ComputeMeshIntegrals volume matches ComputeVolume") && passed;
+	return passed;
+}
+
+//returns the largest distance between corresponding vertices of two meshes with the same connectivity
+static float MaxPositionDifference(const HEMesh& m1, const HEMesh& m2)
+{
+	float maxDifference = 0;
+	for (auto v : m1.vertices())
+		maxDifference = std::max(maxDifference, (m1.point(v) - m2.point(v)).norm());
+	return maxDifference;
+}
+
+//returns the length of the bounding box diagonal of m
+static float BoundingBoxDiagonal(const HEMesh& m)
+{
+	if (m.n_vertices() == 0)
+		return 0;
+	Eigen::Vector3f lower = ToEigenVector(m.point(m.vertex_handle(0))), upper = lower;
+	for (auto v : m.vertices())
+	{
+		lower = lower.cwiseMin(ToEigenVector(m.point(v)));
+		upper = upper.cwiseMax(ToEigenVector(m.point(v)));
+	}
+	return (upper - lower).norm();
+}
+
+//returns the mean distance of the interior vertices to the centers of gravity of their neighbors
+static double MeanUniformLaplacianLength(const HEMesh& m)
+{
+	MeshAdjacency adjacency;
+	BuildMeshAdjacency(m, adjacency);
+	std::vector<Eigen::Vector3f> positions;
+	GetVertexPositions(m, positions);
+	return UniformLaplacianResidual(adjacency, positions);
+}
+
+//smooths result (a copy of the input mesh) and returns the run time in milliseconds
+static double TimeSmoothing(HEMesh& result, bool cotangent, SmoothingScheme scheme, float lamda, unsigned int iterations)
+{
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	if (cotangent)
+	{
+		OpenMesh::VPropHandleT<OpenMesh::Vec3f> cogProperty;
+		OpenMesh::EPropHandleT<double> weights;
+		result.add_property(cogProperty);
+		result.add_property(weights);
+		LaplacianMatrix laplacian;
+		timeStart = std::chrono::high_resolution_clock::now();
+		SmoothCotangentLaplacian(result, lamda, iterations, cogProperty, weights, laplacian, scheme);
+		double time = MillisecondsSince(timeStart);
+		result.remove_property(cogProperty);
+		result.remove_property(weights);
+		return time;
+	}
+	SmoothUniformLaplacian(result, lamda, iterations, scheme);
+	return MillisecondsSince(timeStart);
+}
+
+bool BenchmarkSmoothing(const HEMesh& m, float lamda, unsigned int iterations)
+{
+	auto& pool = nse::util::ThreadPool::Instance();
+	unsigned int previousThreads = pool.NumThreads();
+	//positions that are computed with a different summation order may differ by rounding errors
+	const float tolerance = 1e-5f * BoundingBoxDiagonal(m);
+
+	std::cout << "Uniform Laplacian smoothing of " << m.n_vertices() << " vertices with " << iterations << " iterations .." << std::endl;
+
+	HEMesh reference = m;
+	OpenMesh::VPropHandleT<OpenMesh::Vec3f> cogProperty;
+	reference.add_property(cogProperty);
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	SmoothUniformLaplacianCirculators(reference, lamda, iterations, cogProperty);
+	double referenceTime = MillisecondsSince(timeStart);
+	reference.remove_property(cogProperty);
+
+	pool.SetNumThreads(1);
+	HEMesh flat = m;
+	double flatTime = TimeSmoothing(flat, false, SmoothingScheme::Jacobi, lamda, iterations);
+	pool.SetNumThreads(previousThreads);
+
+	float difference = MaxPositionDifference(reference, flat);
+	std::cout << "Circulators: " << referenceTime << " ms (" << iterations / referenceTime * 1000 << " iterations/s)" << std::endl;
+	std::cout << "Flat arrays: " << flatTime << " ms (" << iterations / flatTime * 1000 << " iterations/s)" << std::endl;
+	std::cout << "Largest position difference: " << difference << std::endl;
+	bool passed = CheckResult(difference <= tolerance, "flat array smoothing matches the circulators");
+
+	VertexColoring coloring;
+	{
+		MeshAdjacency adjacency;
+		BuildMeshAdjacency(m, adjacency);
+		ColorVertices(adjacency, coloring);
+	}
+	std::cout << "Gauss-Seidel uses " << coloring.NumColors() << " colors, mean Laplacian length before smoothing: " << MeanUniformLaplacianLength(m) << std::endl;
+
+	const char* names[] = { "Uniform Jacobi", "Uniform Gauss-Seidel", "Cotangent Jacobi", "Cotangent Gauss-Seidel" };
+	for (int variant = 0; variant < 4; ++variant)
+	{
+		bool cotangent = variant >= 2;
+		SmoothingScheme scheme = variant % 2 == 0 ? SmoothingScheme::Jacobi : SmoothingScheme::ColoredGaussSeidel;
+
+		//every vertex is updated independently within a sweep or color, so the result must not depend on the threads
+		HEMesh result, singleThreadResult;
+		passed = MeasureThreadScaling(names[variant],
+			[&]() { result = m; return TimeSmoothing(result, cotangent, scheme, lamda, iterations); },
+			[&](unsigned int threads)
+			{
+				if (threads != 1)
+					return MaxPositionDifference(singleThreadResult, result) == 0;
+				singleThreadResult = result;
+				std::cout << names[variant] << ": mean Laplacian length " << MeanUniformLaplacianLength(result) << std::endl;
+				return true;
+			}) && passed;
+	}
+	return passed;
+}
+
+bool BenchmarkImplicitSmoothing(const HEMesh& m, float lamda, unsigned int iterations)
+{
+	const unsigned int maxExplicitIterations = 10000;
+	std::cout << "Implicit cotangent smoothing of " << m.n_vertices() << " vertices with lamda " << lamda * iterations << " .." << std::endl;
+
+	OpenMesh::VPropHandleT<OpenMesh::Vec3f> cogProperty;
+	OpenMesh::EPropHandleT<double> weights;
+
+	//one implicit step over the same time as the explicit iterations
+	HEMesh implicitResult = m;
+	LaplacianMatrix laplacian;
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	laplacian.UpdateWeights(implicitResult, LaplacianWeights::Cotangent);
+	ImplicitCotangentSmoothing smoothing;
+	if (!CheckResult(smoothing.Factorize(implicitResult, laplacian, lamda * iterations), "factorization of the implicit smoothing system"))
+		return false;
+	double factorizationTime = MillisecondsSince(timeStart);
+	timeStart = std::chrono::high_resolution_clock::now();
+	smoothing.Smooth(implicitResult, 1);
+	double solveTime = MillisecondsSince(timeStart);
+	double target = MeanUniformLaplacianLength(implicitResult);
+	std::cout << "Implicit: " << factorizationTime << " ms weights and factorization, " << solveTime << " ms per step, mean Laplacian length " << target << std::endl;
+
+	//explicit iterations until the same smoothness is reached
+	HEMesh explicitResult = m;
+	explicitResult.add_property(cogProperty);
+	explicitResult.add_property(weights);
+	LaplacianMatrix explicitLaplacian;
+	double explicitTime = 0;
+	double length = MeanUniformLaplacianLength(explicitResult);
+	unsigned int explicitIterations = 0;
+	while (length > target && explicitIterations < maxExplicitIterations)
+	{
+		timeStart = std::chrono::high_resolution_clock::now();
+		SmoothCotangentLaplacian(explicitResult, lamda, iterations, cogProperty, weights, explicitLaplacian);
+		explicitTime += MillisecondsSince(timeStart);
+		explicitIterations += iterations;
+		length = MeanUniformLaplacianLength(explicitResult);
+	}
+	std::cout << "Explicit: " << explicitTime << " ms for " << explicitIterations << " iterations, mean Laplacian length " << length << std::endl;
+	if (length > target)
+		std::cout << "The explicit smoothing did not reach the smoothness of the implicit step." << std::endl;
+	else
+		std::cout << "Time to equal smoothness: implicit is " << explicitTime / (factorizationTime + solveTime) << " times faster" << std::endl;
+	return CheckResult(target < MeanUniformLaplacianLength(m), "the implicit step smooths the mesh");
+}
+
+bool BenchmarkCotangentWeights(const HEMesh& m)
+{
+	const int repetitions = 10;
+	std::cout << "Cotangent weights of " << m.n_edges() << " edges .." << std::endl;
+
+	HEMesh mesh = m;
+	OpenMesh::EPropHandleT<double> weights, atheta, btheta;
+	mesh.add_property(weights);
+	mesh.add_property(atheta);
+	mesh.add_property(btheta);
+
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repetitions; ++i)
+		CotanWeightFromAngles(mesh, weights, atheta, btheta);
+	double anglesTime = MillisecondsSince(timeStart) / repetitions;
+	std::cout << "From angles: " << anglesTime << " ms" << std::endl;
+
+	//every face writes only its own halfedges, so the weights must not depend on the threads
+	LaplacianMatrix laplacian;
+	std::vector<double> singleThreadWeights;
+	bool passed = MeasureThreadScaling("From dot and cross products",
+		[&]()
+		{
+			auto timeStart = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < repetitions; ++i)
+			{
+				laplacian.Clear();
+				laplacian.UpdateWeights(mesh, LaplacianWeights::Cotangent);
+			}
+			return MillisecondsSince(timeStart) / repetitions;
+		},
+		[&](unsigned int threads)
+		{
+			if (threads == 1)
+				singleThreadWeights = laplacian.EdgeWeights();
+			return laplacian.EdgeWeights() == singleThreadWeights;
+		}, anglesTime);
+
+	//The weights of the angle based formula are only defined for edges with two faces. Its acos of a float dot product
+	//loses accuracy for angles close to 0 or 180 degrees, where the cotangent is large, so the error is taken relative
+	//to max(1, |w|) and edges with such angles are not compared. On the meshes in data/, the largest relative error of
+	//the compared edges is below 4e-4.
+	const double minAngle = 1;
+	const double tolerance = 1e-3;
+	double maxAbsoluteError = 0, maxRelativeError = 0;
+	size_t skippedEdges = 0;
+	for (auto e : mesh.edges())
+	{
+		if (mesh.is_boundary(e))
+			continue;
+		double a = mesh.property(atheta, e), b = mesh.property(btheta, e);
+		if (std::min(a, b) < minAngle || std::max(a, b) > 180 - minAngle)
+		{
+			++skippedEdges;
+			continue;
+		}
+		double reference = mesh.property(weights, e);
+		double error = std::abs(laplacian.EdgeWeights()[e.idx()] - reference);
+		maxAbsoluteError = std::max(maxAbsoluteError, error);
+		maxRelativeError = std::max(maxRelativeError, error / std::max(1.0, std::abs(reference)));
+	}
+	std::cout << "Largest difference to the angle based weights: " << maxAbsoluteError << " (relative " << maxRelativeError
+		<< "), " << skippedEdges << " edges with angles within " << minAngle << " degree of 0 or 180 not compared" << std::endl;
+	passed = CheckResult(maxRelativeError <= tolerance, "cotangent weights match the angle based weights") && passed;
+
+	timeStart = std::chrono::high_resolution_clock::now();
+	size_t updatedFaces = laplacian.UpdateWeights(mesh, LaplacianWeights::Cotangent);
+	std::cout << "Update without moved vertices: " << MillisecondsSince(timeStart) << " ms, " << updatedFaces << " faces recomputed" << std::endl;
+	passed = CheckResult(updatedFaces == 0, "no faces are recomputed without moved vertices") && passed;
+
+	if (mesh.n_vertices() > 0)
+	{
+		auto v = mesh.vertex_handle(0);
+		mesh.point(v) += OpenMesh::Vec3f(0.01f, 0, 0);
+		timeStart = std::chrono::high_resolution_clock::now();
+		updatedFaces = laplacian.UpdateWeights(mesh, LaplacianWeights::Cotangent);
+		std::cout << "Update after moving one vertex: " << MillisecondsSince(timeStart) << " ms, " << updatedFaces << " faces recomputed" << std::endl;
+		size_t adjacentFaces = 0;
+		for (auto f : mesh.vf_range(v))
+		{
+			(void)f;
+			++adjacentFaces;
+		}
+		passed = CheckResult(updatedFaces == adjacentFaces, "only the faces of the moved vertex are recomputed") && passed;
+	}
+	return passed;
+}
+
+bool BenchmarkSmoothingToTolerance(const HEMesh& m, float lamda, double tolerance)
+{
+	const unsigned int maxSweeps = 100000;
+	std::cout << "Uniform Laplacian smoothing of " << m.n_vertices() << " vertices until the residual is reduced to " << tolerance << " .." << std::endl;
+
+	MeshAdjacency adjacency;
+	BuildMeshAdjacency(m, adjacency);
+	std::vector<Eigen::Vector3f> initialPositions;
+	GetVertexPositions(m, initialPositions);
+
+	const char* names[] = { "Jacobi", "Chebyshev" };
+	bool passed = true;
+	std::vector<Eigen::Vector3f> results[2];
+	SmoothingAcceleration accelerations[] = { SmoothingAcceleration::None, SmoothingAcceleration::Chebyshev };
+	for (int i = 0; i < 2; ++i)
+	{
+		results[i] = initialPositions;
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		auto statistics = SmoothUniformLaplacianToTolerance(adjacency, results[i], lamda, tolerance, maxSweeps, accelerations[i]);
+		double time = MillisecondsSince(timeStart);
+		std::cout << names[i] << ": " << statistics.sweeps << " sweeps, " << time << " ms, residual " << statistics.initialResidual << " -> " << statistics.finalResidual
+			<< (statistics.converged ? "" : " (not converged)") << std::endl;
+		//plain Jacobi sweeps may legitimately run out of sweeps on large meshes
+		if (accelerations[i] == SmoothingAcceleration::None)
+			passed = CheckResult(statistics.finalResidual <= statistics.initialResidual, "Jacobi smoothing reduces the residual") && passed;
+		else
+			passed = CheckResult(statistics.converged, std::string(names[i]) + " smoothing reaches the tolerance") && passed;
+	}
+
+	float maxDifference = 0;
+	for (size_t v = 0; v < initialPositions.size(); ++v)
+		maxDifference = std::max(maxDifference, (results[0][v] - results[1][v]).norm());
+	std::cout << "Largest position difference: " << maxDifference << std::endl;
+	return passed;
+}
+
+//returns a mesh with the given number of disjoint copies of m, each copy is shifted along the x axis
+static HEMesh ReplicateMesh(const HEMesh& m, unsigned int copies)
+{
+	HEMesh result;
+	float offset = 0;
+	for (auto v : m.vertices())
+		offset = std::max(offset, std::abs(m.point(v)[0]));
+	offset = 2 * offset + 1;
+
+	std::vector<OpenMesh::VertexHandle> faceVertices;
+	for (unsigned int c = 0; c < copies; ++c)
+	{
+		int firstVertex = (int)result.n_vertices();
+		for (auto v : m.vertices())
+			result.add_vertex(m.point(v) + OpenMesh::Vec3f(c * offset, 0, 0));
+		for (auto f : m.faces())
+		{
+			faceVertices.clear();
+			for (auto v : m.fv_range(f))
+				faceVertices.push_back(result.vertex_handle(firstVertex + v.idx()));
+			result.add_face(faceVertices);
+		}
+	}
+	return result;
+}
+
+bool BenchmarkShellExtraction(const HEMesh& m)
+{
+	//enough copies to get thousands of shells, limited to about two million faces
+	const size_t maxFaces = 2000000;
+	unsigned int copies = (unsigned int)std::max<size_t>(1, std::min<size_t>(1000, maxFaces / std::max<size_t>(1, m.n_faces())));
+	HEMesh mesh = ReplicateMesh(m, copies);
+	std::cout << "Shell extraction on " << copies << " copies of the mesh with " << mesh.n_faces() << " faces .." << std::endl;
+
+	OpenMesh::FPropHandleT<int> floodFillIds, unionFindIds;
+	mesh.add_property(floodFillIds);
+	mesh.add_property(unionFindIds);
+
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	unsigned int floodFillShells = ExtractShellsFloodFill(mesh, floodFillIds);
+	double floodFillTime = MillisecondsSince(timeStart);
+	std::cout << "Flood fill: " << floodFillShells << " shells in " << floodFillTime << " ms" << std::endl;
+
+	unsigned int shells = 0;
+	return MeasureThreadScaling("Union-find",
+		[&]() { shells = ExtractShells(mesh, unionFindIds); },
+		[&](unsigned int)
+		{
+			size_t differentIds = 0;
+			for (auto f : mesh.faces())
+				if (mesh.property(floodFillIds, f) != mesh.property(unionFindIds, f))
+					++differentIds;
+			std::cout << shells << " shells, " << differentIds << " faces with different ids" << std::endl;
+			return shells == floodFillShells && differentIds == 0;
+		}, floodFillTime);
+}
+
+//returns the number of entries whose representative in sets differs from the smallest entry of their set in reference
+template <typename UnionFindType>
+static size_t CountPartitionMismatches(nse::util::UnionFind& reference, UnionFindType& sets, size_t count)
+{
+	std::vector<unsigned int> smallestEntry(count, (unsigned int)-1);
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto& smallest = smallestEntry[reference.GetRepresentative((unsigned int)i)];
+		smallest = std::min(smallest, (unsigned int)i);
+	}
+	size_t mismatches = 0;
+	for (size_t i = 0; i < count; ++i)
+		if (sets.GetRepresentative((unsigned int)i) != sets.GetRepresentative(smallestEntry[reference.GetRepresentative((unsigned int)i)]))
+			++mismatches;
+	return mismatches;
+}
+
+bool BenchmarkUnionFind()
+{
+	const size_t entries = 1 << 22;
+	const size_t merges = entries;
+	//the stress test merges within a small range of entries, such that many threads compete for the same roots
+	const size_t contendedEntries = 1 << 16;
+	const int stressRounds = 20;
+	//the file is written to the temporary directory and removed afterwards
+	const std::string filename = nse::util::TemporaryFilePath("unionfind_benchmark.bin");
+
+	std::cout << "Union-find with " << entries << " entries and " << merges << " random merges .." << std::endl;
+	std::mt19937 rnd(42);
+	std::vector<std::pair<unsigned int, unsigned int>> pairs(merges);
+	for (auto& p : pairs)
+		p = std::make_pair((unsigned int)(rnd() % entries), (unsigned int)(rnd() % entries));
+
+	nse::util::UnionFind reference;
+	const char* policyNames[] = { "by rank", "by size" };
+	nse::util::UnionFind::MergePolicy policies[] = { nse::util::UnionFind::MergePolicy::ByRank, nse::util::UnionFind::MergePolicy::BySize };
+	for (int i = 0; i < 2; ++i)
+	{
+		nse::util::UnionFind sets(policies[i]);
+		sets.AddItems(entries);
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		for (auto& p : pairs)
+			sets.Merge(p.first, p.second);
+		double time = MillisecondsSince(timeStart);
+		std::cout << "Serial, union " << policyNames[i] << ": " << time << " ms (" << merges / time * 1e-3 << " million merges/s)" << std::endl;
+		if (i == 0)
+			reference = sets;
+	}
+
+	nse::util::ConcurrentUnionFind concurrentSets;
+	bool passed = MeasureThreadScaling("Concurrent",
+		[&]()
+		{
+			concurrentSets.Reset(entries);
+			auto timeStart = std::chrono::high_resolution_clock::now();
+			nse::util::ParallelFor(0, merges, [&](size_t i) { concurrentSets.Merge(pairs[i].first, pairs[i].second); });
+			return MillisecondsSince(timeStart);
+		},
+		[&](unsigned int) { return CountPartitionMismatches(reference, concurrentSets, entries) == 0; }, 0, (double)merges, "merges");
+
+	//stress test with all threads
+	auto& pool = nse::util::ThreadPool::Instance();
+	unsigned int previousThreads = pool.NumThreads();
+	pool.SetNumThreads(0);
+	size_t stressMismatches = 0;
+	for (int round = 0; round < stressRounds; ++round)
+	{
+		for (auto& p : pairs)
+			p = std::make_pair((unsigned int)(rnd() % contendedEntries), (unsigned int)(rnd() % contendedEntries));
+		nse::util::UnionFind serialSets;
+		serialSets.AddItems(contendedEntries);
+		for (size_t i = 0; i < contendedEntries / 2; ++i)
+			serialSets.Merge(pairs[i].first, pairs[i].second);
+		concurrentSets.Reset(contendedEntries);
+		nse::util::ParallelFor(0, contendedEntries / 2, [&](size_t i) { concurrentSets.Merge(pairs[i].first, pairs[i].second); });
+		stressMismatches += CountPartitionMismatches(serialSets, concurrentSets, contendedEntries);
+	}
+	std::cout << "Stress test with " << pool.NumThreads() << " threads: " << stressMismatches << " entries in wrong sets" << std::endl;
+	pool.SetNumThreads(previousThreads);
+	passed = CheckResult(stressMismatches == 0, "concurrent merges of contended sets") && passed;
+
+	try
+	{
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		reference.SaveToFile(filename.c_str());
+		double saveTime = MillisecondsSince(timeStart);
+
+		nse::util::UnionFind loaded;
+		timeStart = std::chrono::high_resolution_clock::now();
+		loaded.LoadFromFile(filename.c_str());
+		double loadTime = MillisecondsSince(timeStart);
+
+		nse::util::MappedUnionFind mapped;
+		timeStart = std::chrono::high_resolution_clock::now();
+		mapped.Open(filename.c_str());
+		double mapTime = MillisecondsSince(timeStart);
+
+		size_t mismatches = CountPartitionMismatches(reference, loaded, entries) + CountPartitionMismatches(reference, mapped, entries);
+		std::cout << "Save: " << saveTime << " ms, load: " << loadTime << " ms, map: " << mapTime << " ms, "
+			<< mismatches << " entries in wrong sets after reloading" << std::endl;
+		passed = CheckResult(mismatches == 0, "saved, loaded and mapped union-find") && passed;
+	}
+	catch (std::exception& e)
+	{
+		passed = CheckResult(false, std::string("union-find persistence: ") + e.what());
+	}
+	std::remove(filename.c_str());
+	return passed;
+}
+
+//inserts all faces of m into set, then samples and removes faces until the set is empty, returns the time in ms
+template <typename SetType>
+static double TimeSampleSet(const HEMesh& m, SetType& set, unsigned int repetitions, size_t& checksum)
+{
+	std::mt19937 eng(42);
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int r = 0; r < repetitions; ++r)
+	{
+		set.clear();
+		for (auto f : m.faces())
+			set.insert(f);
+		while (!set.empty())
+		{
+			auto f = set.sample(eng);
+			checksum += f.idx();
+			set.remove(f);
+		}
+	}
+	return MillisecondsSince(timeStart);
+}
+
+bool BenchmarkSampleSets(const HEMesh& m, unsigned int nTrials)
+{
+	if (m.n_faces() == 0)
+		return true;
+	const unsigned int repetitions = 10;
+	std::cout << "Sample sets with " << m.n_faces() << " face handles, " << repetitions << " repetitions .." << std::endl;
+
+	hashed_sample_set<OpenMesh::FaceHandle> hashed;
+	sample_set<OpenMesh::FaceHandle> dense;
+	hashed.reserve(m.n_faces());
+	dense.reserve(m.n_faces());
+	size_t hashedChecksum = 0, denseChecksum = 0;
+	double hashedTime = TimeSampleSet(m, hashed, repetitions, hashedChecksum);
+	double denseTime = TimeSampleSet(m, dense, repetitions, denseChecksum);
+	std::cout << "Hash map: " << hashedTime << " ms, flat array: " << denseTime << " ms, speedup " << hashedTime / denseTime << std::endl;
+	//every face must be sampled exactly once per repetition
+	size_t expectedChecksum = repetitions * (m.n_faces() * (m.n_faces() - 1) / 2);
+	bool passed = CheckResult(hashedChecksum == expectedChecksum, "the hash map sample set returns every face once");
+	passed = CheckResult(denseChecksum == expectedChecksum, "the flat array sample set returns every face once") && passed;
+
+	HEMesh mesh = m;
+	OpenMesh::FPropHandleT<int> ids;
+	mesh.add_property(ids);
+
+	auto faceIds = [&]()
+	{
+		std::vector<int> result;
+		result.reserve(mesh.n_faces());
+		for (auto f : mesh.faces())
+			result.push_back(mesh.property(ids, f));
+		return result;
+	};
+
+	//both set types keep their elements in the same order, so the random trials must choose the same strips
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	unsigned int hashedStrips = ExtractTriStrips<hashed_sample_set<OpenMesh::FaceHandle>>(mesh, ids, nTrials);
+	hashedTime = MillisecondsSince(timeStart);
+	auto hashedIds = faceIds();
+	timeStart = std::chrono::high_resolution_clock::now();
+	unsigned int strips = ExtractTriStrips(mesh, ids, nTrials);
+	denseTime = MillisecondsSince(timeStart);
+	std::cout << "ExtractTriStrips with " << nTrials << " trials, " << strips << " strips, hash map: " << hashedTime
+		<< " ms, flat array: " << denseTime << " ms, speedup " << hashedTime / denseTime << std::endl;
+	passed = CheckResult(hashedStrips == strips && hashedIds == faceIds(), "the strips do not depend on the sample set") && passed;
+
+	//ExtractShells merges faces with a union-find and uses no sample set, the flood fill shows the difference of the sets
+	timeStart = std::chrono::high_resolution_clock::now();
+	unsigned int shells = ExtractShells(mesh, ids);
+	double unionFindTime = MillisecondsSince(timeStart);
+	auto shellIds = faceIds();
+	timeStart = std::chrono::high_resolution_clock::now();
+	unsigned int hashedShells = ExtractShellsFloodFill<hashed_sample_set<OpenMesh::FaceHandle>>(mesh, ids);
+	hashedTime = MillisecondsSince(timeStart);
+	hashedIds = faceIds();
+	timeStart = std::chrono::high_resolution_clock::now();
+	unsigned int denseShells = ExtractShellsFloodFill(mesh, ids);
+	denseTime = MillisecondsSince(timeStart);
+	std::cout << "ExtractShells: " << shells << " shells in " << unionFindTime << " ms, flood fill with hash map: " << hashedTime
+		<< " ms, flat array: " << denseTime << " ms, speedup " << hashedTime / denseTime << std::endl;
+	passed = CheckResult(hashedShells == shells && denseShells == shells && hashedIds == shellIds && faceIds() == shellIds,
+		"the flood fill with both sample sets finds the shells of ExtractShells") && passed;
+	return passed;
+}
+
+bool BenchmarkStripification(const HEMesh& m, unsigned int nTrials)
+{
+	HEMesh mesh = m;
+	mesh.triangulate();
+	if (mesh.n_faces() == 0)
+		return true;
+	OpenMesh::FPropHandleT<int> ids;
+	mesh.add_property(ids);
+	std::cout << "Stripification of " << mesh.n_faces() << " triangles, " << nTrials << " random trials .." << std::endl;
+
+	const char* names[] = { "Random trials", "Degree priority" };
+	double times[2];
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		unsigned int strips = ExtractTriStrips(mesh, ids, nTrials, (StripificationMode)mode);
+		times[mode] = MillisecondsSince(timeStart);
+		std::cout << names[mode] << ": " << strips << " strips, average length " << (double)mesh.n_faces() / strips
+			<< " triangles, " << times[mode] << " ms" << std::endl;
+	}
+	std::cout << "Speedup: " << times[0] / times[1] << std::endl;
+
+	//ties between trials go to the first seed, so the strips must not depend on the threads
+	bool passed = true;
+	std::vector<int> referenceIds(mesh.n_faces());
+	for (unsigned int trials : { 1u, 5u, 20u, 50u, 200u })
+	{
+		unsigned int strips = 0, referenceStrips = 0;
+		passed = MeasureThreadScaling(std::to_string(trials) + " trials",
+			[&]() { strips = ExtractTriStrips(mesh, ids, trials); },
+			[&](unsigned int threads)
+			{
+				size_t differentIds = 0;
+				for (auto f : mesh.faces())
+				{
+					if (threads == 1)
+						referenceIds[f.idx()] = mesh.property(ids, f);
+					else if (referenceIds[f.idx()] != mesh.property(ids, f))
+						++differentIds;
+				}
+				if (threads == 1)
+					referenceStrips = strips;
+				std::cout << strips << " strips, " << differentIds << " faces with different ids" << std::endl;
+				return strips == referenceStrips && differentIds == 0;
+			}) && passed;
+	}
+	return passed;
+}
+
+//returns the triangles of an index list, rotated such that the smallest index comes first, in sorted order
+static std::vector<std::array<uint32_t, 3>> SortedTriangles(const std::vector<uint32_t>& indices)
+{
+	std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+	for (size_t t = 0; t < triangles.size(); ++t)
+	{
+		size_t first = 3 * t + (size_t)(std::min_element(&indices[3 * t], &indices[3 * t] + 3) - &indices[3 * t]);
+		for (size_t c = 0; c < 3; ++c)
+			triangles[t][c] = indices[3 * t + (first - 3 * t + c) % 3];
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+bool BenchmarkVertexCache(const HEMesh& m)
+{
+	std::vector<uint32_t> meshOrder;
+	GetTriangleIndices(m, meshOrder);
+	if (meshOrder.empty())
+		return true;
+	std::cout << "Vertex cache optimization of " << meshOrder.size() / 3 << " triangles .." << std::endl;
+
+	auto vertexCache = meshOrder;
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	OptimizeVertexCache(vertexCache, m.n_vertices());
+	double vertexCacheTime = MillisecondsSince(timeStart);
+
+	std::vector<Eigen::Vector3f> positions;
+	GetVertexPositions(m, positions);
+	auto overdraw = vertexCache;
+	timeStart = std::chrono::high_resolution_clock::now();
+	size_t clusters = OptimizeOverdraw(overdraw, positions);
+	double overdrawTime = MillisecondsSince(timeStart);
+
+	auto print = [&](const char* name, const std::vector<uint32_t>& indices)
+	{
+		std::cout << name;
+		for (unsigned int cacheSize : { 16u, 32u })
+		{
+			auto stats = AnalyzeVertexCache(indices, m.n_vertices(), cacheSize);
+			std::cout << ", cache size " << cacheSize << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr;
+		}
+		std::cout << std::endl;
+	};
+	print("Mesh order", meshOrder);
+	print("Vertex cache order", vertexCache);
+	print("Vertex cache and overdraw order", overdraw);
+	std::cout << "Vertex cache optimization: " << vertexCacheTime << " ms, overdraw optimization: " << overdrawTime << " ms with "
+		<< clusters << " clusters" << std::endl;
+
+	//the optimizations may only reorder the triangles, the corners of a triangle keep their winding
+	auto triangles = SortedTriangles(meshOrder);
+	bool passed = CheckResult(SortedTriangles(vertexCache) == triangles, "the vertex cache order keeps all triangles");
+	passed = CheckResult(SortedTriangles(overdraw) == triangles, "the overdraw order keeps all triangles") && passed;
+	return passed;
+}
+
+//Set-associative LRU data cache, only counts the misses of the simulated loads
+class SimulatedCache
+{
+public:
+	SimulatedCache(unsigned int sizeInBytes = 32 * 1024, unsigned int ways = 8, unsigned int lineSize = 64)
+		: ways(ways), lineSize(lineSize), sets(sizeInBytes / (ways * lineSize)), tags(sets * ways, -1), lastUse(sets * ways, 0)
+	{ }
+
+	//loads size bytes starting at address
+	void Load(long long address, unsigned int size)
+	{
+		for (long long line = address / lineSize; line <= (address + size - 1) / lineSize; ++line)
+		{
+			++loads;
+			size_t set = (size_t)(line % sets) * ways;
+			size_t victim = set;
+			bool hit = false;
+			for (size_t i = set; i < set + ways && !hit; ++i)
+			{
+				if (tags[i] == line)
+				{
+					lastUse[i] = loads;
+					hit = true;
+				}
+				else if (lastUse[i] < lastUse[victim])
+					victim = i;
+			}
+			if (!hit)
+			{
+				++misses;
+				tags[victim] = line;
+				lastUse[victim] = loads;
+			}
+		}
+	}
+
+	long long misses = 0;
+
+private:
+	unsigned int ways, lineSize, sets;
+	std::vector<long long> tags, lastUse;
+	long long loads = 0;
+};
+
+//the simulated arrays are placed far apart from each other, element sizes are those of the OpenMesh array kernel
+const long long simulatedPointArray = 0;
+const long long simulatedHalfedgeArray = 1ll << 40;
+const long long simulatedFaceArray = 2ll << 40;
+const unsigned int simulatedPointSize = sizeof(OpenMesh::Vec3f);
+const unsigned int simulatedHalfedgeSize = 4 * sizeof(int);
+const unsigned int simulatedFaceSize = sizeof(int);
+
+bool BenchmarkSpatialOrder(const HEMesh& m, float lamda, unsigned int iterations)
+{
+	bool passed = true;
+	double shuffledArea = 0, shuffledLaplacian = 0;
+	std::cout << "Spatial order of " << m.n_vertices() << " vertices and " << m.n_faces() << " faces .." << std::endl;
+
+	//the copies are rebuilt by PermuteMesh, which keeps the registered properties of m but resets their values, the
+	//benchmark only reads the points and the smoothing computes its own properties
+	HEMesh shuffled = m;
+	if (!CheckResult(ShuffleMesh(shuffled, 0), "rebuilding the shuffled mesh"))
+		return false;
+
+	std::cout << "Cache misses are counted by a software simulation of a 32 KB, 8-way L1 data cache, not by hardware counters." << std::endl;
+	std::cout << std::setw(10) << "order" << std::setw(14) << "reorder (ms)" << std::setw(14) << "smooth (ms)" << std::setw(22) << "sim. smooth misses"
+		<< std::setw(12) << "area (ms)" << std::setw(20) << "sim. area misses" << std::setw(14) << "area" << std::setw(14) << "laplacian" << std::endl;
+	const char* names[] = { "shuffled", "Morton", "Hilbert" };
+	for (int order = 0; order < 3; ++order)
+	{
+		HEMesh ordered = shuffled;
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		bool rebuilt = order == 0 || ReorderMeshAlongCurve(ordered, order == 1 ? SpaceFillingCurve::Morton : SpaceFillingCurve::Hilbert);
+		double reorderTime = MillisecondsSince(timeStart);
+		if (!CheckResult(rebuilt, std::string("rebuilding the mesh in ") + names[order] + " order"))
+		{
+			passed = false;
+			continue;
+		}
+
+		//one smoothing sweep gathers the positions of the one-ring of every vertex
+		SimulatedCache smoothCache;
+		MeshAdjacency adjacency;
+		BuildMeshAdjacency(ordered, adjacency);
+		for (unsigned int i = 0; i < adjacency.NumVertices(); ++i)
+		{
+			smoothCache.Load(simulatedPointArray + (long long)i * simulatedPointSize, simulatedPointSize);
+			for (unsigned int j = adjacency.offsets[i]; j < adjacency.offsets[i + 1]; ++j)
+				smoothCache.Load(simulatedPointArray + (long long)adjacency.neighbors[j] * simulatedPointSize, simulatedPointSize);
+		}
+
+		//the surface area follows the halfedges of every face to their points
+		SimulatedCache areaCache;
+		for (auto f : ordered.faces())
+		{
+			areaCache.Load(simulatedFaceArray + (long long)f.idx() * simulatedFaceSize, simulatedFaceSize);
+			for (auto h : ordered.fh_range(f))
+			{
+				areaCache.Load(simulatedHalfedgeArray + (long long)h.idx() * simulatedHalfedgeSize, simulatedHalfedgeSize);
+				areaCache.Load(simulatedHalfedgeArray + (long long)ordered.opposite_halfedge_handle(h).idx() * simulatedHalfedgeSize, simulatedHalfedgeSize);
+				areaCache.Load(simulatedPointArray + (long long)ordered.to_vertex_handle(h).idx() * simulatedPointSize, simulatedPointSize);
+			}
+		}
+
+		timeStart = std::chrono::high_resolution_clock::now();
+		float area = ComputeSurfaceArea(ordered);
+		double areaTime = MillisecondsSince(timeStart);
+
+		double smoothTime = TimeSmoothing(ordered, false, SmoothingScheme::Jacobi, lamda, iterations);
+		double laplacian = MeanUniformLaplacianLength(ordered);
+
+		std::cout << std::setw(10) << names[order] << std::setw(14) << reorderTime << std::setw(14) << smoothTime << std::setw(22) << smoothCache.misses
+			<< std::setw(12) << areaTime << std::setw(20) << areaCache.misses << std::setw(14) << area << std::setw(14) << laplacian << std::endl;
+
+		//reordering must not change the geometry or the smoothing, only the summation order. The float sum of
+		//ComputeSurfaceArea is too sensitive to the order, the compensated sum of ComputeMeshIntegrals is compared.
+		double integralArea = ComputeMeshIntegrals(ordered).area;
+		if (order == 0)
+		{
+			shuffledArea = integralArea;
+			shuffledLaplacian = laplacian;
+		}
+		passed = CheckResult(RelativelyClose(integralArea, shuffledArea, 1e-6), std::string("surface area in ") + names[order] + " order") && passed;
+		passed = CheckResult(RelativelyClose(laplacian, shuffledLaplacian, 1e-4), std::string("smoothing in ") + names[order] + " order") && passed;
+	}
+	return passed;
+}
+
+//returns the number of copies of m that have at least 5 million vertices
+static unsigned int CopiesForRendererBenchmark(const HEMesh& m)
+{
+	const size_t targetVertices = 5000000;
+	return (unsigned int)((targetVertices + m.n_vertices() - 1) / m.n_vertices());
+}
+
+bool BenchmarkRendererUpdates(const HEMesh& m, float lamda)
+{
+	if (m.n_vertices() == 0)
+		return true;
+	HEMesh large = ReplicateMesh(m, CopiesForRendererBenchmark(m));
+	std::cout << "MeshRenderer updates of " << large.n_vertices() << " vertices and " << large.n_faces() << " faces .." << std::endl;
+
+	//glFinish makes the measurement include the transfers to the GPU
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	MeshRenderer renderer(large);
+	glFinish();
+	std::cout << "Initial Update in the original triangle order: " << MillisecondsSince(timeStart) << " ms, "
+		<< renderer.UploadedBytes() / (1024.0 * 1024.0) << " MB uploaded" << std::endl;
+
+	auto measure = [&](const char* name, bool geometryOnly) -> size_t
+	{
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		if (geometryOnly)
+			renderer.UpdateGeometry();
+		else
+			renderer.Update();
+		glFinish();
+		std::cout << name << (geometryOnly ? ", UpdateGeometry: " : ", Update: ") << MillisecondsSince(timeStart) << " ms, "
+			<< renderer.UploadedBytes() / (1024.0 * 1024.0) << " MB uploaded" << std::endl;
+		return renderer.UploadedBytes();
+	};
+	auto moveVertices = [&]()
+	{
+		for (size_t i = 0; i < large.n_vertices() / 100; ++i)
+		{
+			auto v = large.vertex_handle((unsigned int)i);
+			large.set_point(v, large.point(v) + OpenMesh::Vec3f(0, 0.01f, 0));
+		}
+	};
+
+	bool passed = true;
+	for (bool geometryOnly : { false, true })
+	{
+		passed = CheckResult(measure("No changes", geometryOnly) == 0, "nothing is uploaded without changes") && passed;
+		moveVertices();
+		size_t movedBytes = measure("1 % of the vertices moved", geometryOnly);
+		SmoothUniformLaplacian(large, lamda, 1);
+		size_t smoothedBytes = measure("All vertices smoothed", geometryOnly);
+		passed = CheckResult(movedBytes > 0 && movedBytes < smoothedBytes, "moving few vertices uploads less than moving all") && passed;
+	}
+	renderer.InvalidateBuffers();
+	measure("After InvalidateBuffers", false);
+	return passed;
+}
+
+bool BenchmarkVertexFormats(const HEMesh& m)
+{
+	if (m.n_vertices() == 0)
+		return true;
+	HEMesh large = ReplicateMesh(m, CopiesForRendererBenchmark(m));
+	std::cout << "Vertex formats for " << large.n_vertices() << " vertices and " << large.n_faces() << " faces .." << std::endl;
+
+	MeshRenderer renderer(large);
+	const char* names[] = { "Float", "Packed", "Quantized" };
+	bool passed = true;
+	size_t previousMemory = 0;
+	for (int format = 0; format < 3; ++format)
+	{
+		renderer.SetVertexFormat((VertexFormat)format);
+		glFinish();
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		renderer.UpdateGeometry();
+		glFinish();
+		double uploadTime = MillisecondsSince(timeStart);
+		std::cout << names[format] << ": " << renderer.UploadedBytes() / (double)large.n_vertices() << " bytes per vertex, "
+			<< renderer.GPUMemoryBytes() / (1024.0 * 1024.0) << " MB of GPU memory including indices, upload took " << uploadTime << " ms" << std::endl;
+		//every format is smaller than the previous one
+		if (format > 0)
+			passed = CheckResult(renderer.GPUMemoryBytes() < previousMemory, std::string(names[format]) + " vertices use less memory than " + names[format - 1]) && passed;
+		previousMemory = renderer.GPUMemoryBytes();
+	}
+	return passed;
+}
+
+bool BenchmarkVertexNormals(const HEMesh& m)
+{
+	if (m.n_faces() == 0)
+		return true;
+	HEMesh mesh = ReplicateMesh(m, CopiesForRendererBenchmark(m));
+	std::cout << "Vertex normals of " << mesh.n_vertices() << " vertices and " << mesh.n_faces() << " faces .." << std::endl;
+
+	std::vector<Eigen::Vector3f> circulated(mesh.n_vertices());
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	for (auto v : mesh.vertices())
+	{
+		OpenMesh::Vec3f n;
+		mesh.calc_vertex_normal_correct(v, n);
+		circulated[v.idx()] = ToEigenVector(n);
+	}
+	std::cout << "Vertex circulation: " << MillisecondsSince(timeStart) << " ms" << std::endl;
+
+	//both sum the same cross products for triangles, in a different order and with a different scale for polygons
+	bool triangles = true;
+	for (auto f : mesh.faces())
+		triangles = triangles && mesh.valence(f) == 3;
+	std::vector<Eigen::Vector3f> reference, normals;
+	return MeasureThreadScaling("ComputeVertexNormals",
+		[&]() { ComputeVertexNormals(mesh, normals); },
+		[&](unsigned int threads)
+		{
+			//relative to the length of the normal, which scales with the area of the faces
+			float maxDifference = 0;
+			for (size_t i = 0; i < normals.size(); ++i)
+				maxDifference = std::max(maxDifference, (normals[i] - circulated[i]).norm() / std::max(circulated[i].norm(), 1e-30f));
+			if (threads == 1)
+				reference = normals;
+			std::cout << "Largest relative difference to circulation: " << maxDifference << std::endl;
+			return normals == reference && (!triangles || maxDifference <= 1e-4f);
+		}, 0, (double)mesh.n_vertices(), "vertices");
+}
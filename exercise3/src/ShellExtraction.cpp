@@ -4,8 +4,67 @@
 
 #include "ShellExtraction.h"
 #include <sample_set.h>
+#include <util/ConcurrentUnionFind.h>
+#include <util/Parallel.h>
+
+//number of faces that are numbered by one task
+const size_t shellChunkSize = 4096;
 
 unsigned int ExtractShells(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex)
+{
+	size_t nFaces = m.n_faces();
+	nse::util::ConcurrentUnionFind faceSets;
+	faceSets.Reset(nFaces);
+
+	nse::util::ParallelFor(0, m.n_edges(), [&](size_t e)
+	{
+		auto h = m.halfedge_handle(m.edge_handle((int)e), 0);
+		auto f0 = m.face_handle(h);
+		auto f1 = m.face_handle(m.opposite_halfedge_handle(h));
+		if (f0.is_valid() && f1.is_valid())
+			faceSets.Merge(f0.idx(), f1.idx());
+	});
+
+	//the representative of a shell is its first face, count the representatives per chunk
+	std::vector<unsigned int> chunkShells((nFaces + shellChunkSize - 1) / shellChunkSize, 0);
+	nse::util::ParallelForChunks(0, nFaces, shellChunkSize, [&](size_t chunk, size_t begin, size_t end, unsigned int)
+	{
+		unsigned int count = 0;
+		for (size_t i = begin; i < end; ++i)
+			if (faceSets.GetRepresentative((unsigned int)i) == i)
+				++count;
+		chunkShells[chunk] = count;
+	});
+
+	//exclusive prefix sum gives the first shell index of every chunk
+	unsigned int shellCount = 0;
+	for (auto& c : chunkShells)
+	{
+		unsigned int count = c;
+		c = shellCount;
+		shellCount += count;
+	}
+
+	//number the representatives, faces always come after their representative
+	nse::util::ParallelForChunks(0, nFaces, shellChunkSize, [&](size_t chunk, size_t begin, size_t end, unsigned int)
+	{
+		unsigned int shellId = chunkShells[chunk];
+		for (size_t i = begin; i < end; ++i)
+			if (faceSets.GetRepresentative((unsigned int)i) == i)
+				m.property(perFaceShellIndex, m.face_handle((int)i)) = shellId++;
+	});
+	nse::util::ParallelFor(0, nFaces, [&](size_t i)
+	{
+		unsigned int representative = faceSets.GetRepresentative((unsigned int)i);
+		if (representative != i)
+			m.property(perFaceShellIndex, m.face_handle((int)i)) = m.property(perFaceShellIndex, m.face_handle((int)representative));
+	});
+
+	return shellCount;
+}
+
+template <typename FaceSet>
+unsigned int ExtractShellsFloodFill(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex)
 {
 	//reset the shell indices to -1 for every face
 	for (auto f : m.faces())
@@ -15,9 +74,12 @@ unsigned int ExtractShells(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIn
 	unsigned int shellId = 0;
 
 	/*Task 2.2.3*/
+	//the queue is reused for all shells
+	FaceSet connectedSet;
+	connectedSet.reserve(m.n_faces());
 	for (auto f : m.faces()){
 		if (m.property(perFaceShellIndex, f) == -1){
-			connectedShell(m, perFaceShellIndex, f, shellId);
+			connectedShell(m, perFaceShellIndex, f, shellId, connectedSet);
 			shellId++;
 		}
 	}
@@ -27,10 +89,11 @@ unsigned int ExtractShells(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIn
 	return shellId;
 }
 
-void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle seed, unsigned int shellId){
+template <typename FaceSet>
+void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle seed, unsigned int shellId, FaceSet& connectedSet){
 
 	// Initialize new Set of connected components to en empty que of FaceHandles Q ← {}
-	sample_set<OpenMesh::FaceHandle> connectedSet;
+	connectedSet.clear();
 
 	// Insert the seed face into the queue
 	//B ← {s0}
@@ -60,6 +123,11 @@ void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, Op
 	}
 }
 
+template unsigned int ExtractShellsFloodFill<sample_set<OpenMesh::FaceHandle>>(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex);
+template unsigned int ExtractShellsFloodFill<hashed_sample_set<OpenMesh::FaceHandle>>(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex);
+template void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle seed, unsigned int shellId, sample_set<OpenMesh::FaceHandle>& connectedSet);
+template void connectedShell(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle seed, unsigned int shellId, hashed_sample_set<OpenMesh::FaceHandle>& connectedSet);
+
 std::vector<OpenMesh::FaceHandle> getConnectedFaces(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex, OpenMesh::FaceHandle faceHandle){
 
 	std::vector<OpenMesh::FaceHandle> connectedFaces;
@@ -71,7 +139,10 @@ std::vector<OpenMesh::FaceHandle> getConnectedFaces(HEMesh& m, OpenMesh::FPropHa
 		 ++fh_iter){
 		//get the opposite halfedge handle which is incident to the neighboring face
 		OpenMesh::HalfedgeHandle oppositeHalfedgeHandle = m.opposite_halfedge_handle(fh_iter.operator*());
-			connectedFaces.emplace_back(m.face_handle(oppositeHalfedgeHandle));
+		//boundary halfedges have no face
+		if (m.is_boundary(oppositeHalfedgeHandle))
+			continue;
+		connectedFaces.emplace_back(m.face_handle(oppositeHalfedgeHandle));
 	}
 
 	return connectedFaces;
@@ -5,11 +5,213 @@
 #include "Smoothing.h"
 #include <random>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <util/MeshNormals.h>
+#include <util/Parallel.h>
 
 
-void SmoothUniformLaplacian(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f > vertexCogProperty)
+void SmoothUniformLaplacian(HEMesh& m, float lamda, unsigned int iterations, SmoothingScheme scheme)
+{
+	MeshAdjacency adjacency;
+	BuildMeshAdjacency(m, adjacency);
+	std::vector<Eigen::Vector3f> positions;
+	GetVertexPositions(m, positions);
+
+	if (scheme == SmoothingScheme::Jacobi)
+	{
+		//all centers of gravity are computed from the positions of the previous iteration
+		std::vector<Eigen::Vector3f> newPositions(positions.size());
+		for (unsigned int i = 0; i < iterations; ++i)
+		{
+			nse::util::ParallelFor(0, positions.size(), [&](size_t v)
+			{
+				newPositions[v] = UniformLaplacianStep(adjacency, positions, lamda, v);
+			});
+			std::swap(positions, newPositions);
+		}
+	}
+	else
+	{
+		//the vertices of one color have no neighbors of the same color and can be updated in place
+		VertexColoring coloring;
+		ColorVertices(adjacency, coloring);
+		for (unsigned int i = 0; i < iterations; ++i)
+			for (size_t c = 0; c < coloring.NumColors(); ++c)
+				nse::util::ParallelFor(coloring.offsets[c], coloring.offsets[c + 1], [&](size_t j)
+				{
+					unsigned int v = coloring.vertices[j];
+					positions[v] = UniformLaplacianStep(adjacency, positions, lamda, v);
+				});
+	}
+
+	SetVertexPositions(m, positions);
+}
+
+Eigen::Vector3f UniformLaplacianStep(const MeshAdjacency& adjacency, const std::vector<Eigen::Vector3f>& positions, float lamda, size_t v)
+{
+	unsigned int begin = adjacency.offsets[v], end = adjacency.offsets[v + 1];
+	if (adjacency.boundary[v] || begin == end)
+		return positions[v];
+	Eigen::Vector3f cog = Eigen::Vector3f::Zero();
+	for (unsigned int j = begin; j < end; ++j)
+		cog += positions[adjacency.neighbors[j]];
+	cog /= (float)(end - begin);
+	return positions[v] + lamda * (cog - positions[v]);
+}
+
+//number of vertices whose residuals are summed by one task
+const size_t residualChunkSize = 4096;
+
+//number of plain Jacobi sweeps that are used to estimate the spectral radius for the Chebyshev acceleration
+const unsigned int chebyshevEstimationSweeps = 16;
+
+//number of Chebyshev sweeps after which the spectral radius is checked against the observed convergence
+const unsigned int chebyshevCycleLength = 32;
+
+//upper bound for the estimated spectral radius
+const double maxSpectralRadius = 0.9999;
+
+//Performs one sweep of the uniform Laplacian smoothing on x and returns the residual of x.
+//Without older, out receives the Jacobi update G x. Otherwise out receives the Chebyshev update
+//omega (G x - older) + older, where out may be the same array as older.
+static double UniformSmoothingSweep(const MeshAdjacency& adjacency, const std::vector<Eigen::Vector3f>& x, const std::vector<Eigen::Vector3f>* older, std::vector<Eigen::Vector3f>& out, float lamda, double omega)
+{
+	size_t n = x.size();
+	std::vector<double> chunkSums((n + residualChunkSize - 1) / residualChunkSize, 0.0);
+	std::vector<size_t> chunkCounts(chunkSums.size(), 0);
+	nse::util::ParallelForChunks(0, n, residualChunkSize, [&](size_t chunk, size_t begin, size_t end, unsigned int)
+	{
+		double sum = 0;
+		size_t count = 0;
+		for (size_t v = begin; v < end; ++v)
+		{
+			unsigned int first = adjacency.offsets[v], last = adjacency.offsets[v + 1];
+			Eigen::Vector3f update = x[v];
+			if (!adjacency.boundary[v] && first != last)
+			{
+				Eigen::Vector3f cog = Eigen::Vector3f::Zero();
+				for (unsigned int j = first; j < last; ++j)
+					cog += x[adjacency.neighbors[j]];
+				cog /= (float)(last - first);
+				sum += (cog - x[v]).norm();
+				++count;
+				update += lamda * (cog - x[v]);
+			}
+			if (older)
+				out[v] = (*older)[v] + (float)omega * (update - (*older)[v]);
+			else
+				out[v] = update;
+		}
+		chunkSums[chunk] = sum;
+		chunkCounts[chunk] = count;
+	});
+
+	double sum = 0;
+	size_t count = 0;
+	for (size_t i = 0; i < chunkSums.size(); ++i)
+	{
+		sum += chunkSums[i];
+		count += chunkCounts[i];
+	}
+	return count == 0 ? 0 : sum / count;
+}
+
+double UniformLaplacianResidual(const MeshAdjacency& adjacency, const std::vector<Eigen::Vector3f>& positions)
+{
+	std::vector<Eigen::Vector3f> scratch(positions.size());
+	return UniformSmoothingSweep(adjacency, positions, nullptr, scratch, 0, 1);
+}
+
+SmoothingStatistics SmoothUniformLaplacianToTolerance(HEMesh& m, float lamda, double tolerance, unsigned int maxSweeps, SmoothingAcceleration acceleration)
+{
+	MeshAdjacency adjacency;
+	BuildMeshAdjacency(m, adjacency);
+	std::vector<Eigen::Vector3f> positions;
+	GetVertexPositions(m, positions);
+	auto statistics = SmoothUniformLaplacianToTolerance(adjacency, positions, lamda, tolerance, maxSweeps, acceleration);
+	SetVertexPositions(m, positions);
+	return statistics;
+}
+
+SmoothingStatistics SmoothUniformLaplacianToTolerance(const MeshAdjacency& adjacency, std::vector<Eigen::Vector3f>& x, float lamda, double tolerance, unsigned int maxSweeps, SmoothingAcceleration acceleration)
+{
+	std::vector<Eigen::Vector3f> older(x.size()), scratch(x.size());
+
+	SmoothingStatistics statistics;
+	double previousResidual = 0, spectralRadius = 0, omega = 1;
+	bool chebyshev = acceleration == SmoothingAcceleration::Chebyshev;
+	//number of sweeps since the (re)start of the Chebyshev iteration, the first one is a plain Jacobi sweep
+	unsigned int chebyshevStep = 0;
+	unsigned int cycleStart = 0;
+	double cycleResidual = 0;
+	while (true)
+	{
+		bool accelerate = chebyshev && statistics.sweeps >= chebyshevEstimationSweeps && chebyshevStep > 0;
+		if (accelerate)
+		{
+			double rho2 = spectralRadius * spectralRadius;
+			omega = chebyshevStep == 1 ? 2 / (2 - rho2) : 4 / (4 - rho2 * omega);
+		}
+
+		//the sweep computes the residual of the current positions x
+		double residual = accelerate
+			? UniformSmoothingSweep(adjacency, x, &older, older, lamda, omega)
+			: UniformSmoothingSweep(adjacency, x, nullptr, scratch, lamda, 1);
+		if (statistics.sweeps == 0)
+			statistics.initialResidual = residual;
+		statistics.finalResidual = residual;
+		statistics.converged = residual <= tolerance * statistics.initialResidual;
+		//without step size the positions do not change
+		if (statistics.converged || statistics.sweeps == maxSweeps || lamda <= 0)
+			break;
+
+		if (accelerate)
+			std::swap(x, older);
+		else
+		{
+			if (statistics.sweeps < chebyshevEstimationSweeps && previousResidual > 0)
+				spectralRadius = std::min(maxSpectralRadius, residual / previousResidual);
+			std::swap(older, x);
+			std::swap(x, scratch);
+		}
+
+		if (chebyshev && statistics.sweeps >= chebyshevEstimationSweeps)
+		{
+			if (chebyshevStep == 0)
+			{
+				cycleStart = statistics.sweeps;
+				cycleResidual = residual;
+			}
+			++chebyshevStep;
+			if (statistics.sweeps - cycleStart == chebyshevCycleLength)
+			{
+				//modes with eigenvalues up to the spectral radius decay at least by c per sweep. A slower observed
+				//decay q stems from a mode with eigenvalue t > spectralRadius, for which q = c (z + sqrt(z^2 - 1))
+				//with z = t / spectralRadius. Restart with t as new estimate.
+				double q = std::pow(residual / cycleResidual, 1.0 / chebyshevCycleLength);
+				double c = spectralRadius / (1 + std::sqrt(1 - spectralRadius * spectralRadius));
+				if (q > c && spectralRadius < maxSpectralRadius)
+				{
+					double ratio = q / c;
+					spectralRadius = std::min(maxSpectralRadius, spectralRadius * (ratio + 1 / ratio) / 2);
+					chebyshevStep = 0;
+				}
+				else
+				{
+					cycleStart = statistics.sweeps;
+					cycleResidual = residual;
+				}
+			}
+		}
+		previousResidual = residual;
+		++statistics.sweeps;
+	}
+	return statistics;
+}
+
+void SmoothUniformLaplacianCirculators(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f > vertexCogProperty)
 {
-	std::cout << "_______________________________________Uniform Laplacian Smoothing_______________________________________" << std::endl;
 	/*Task 2.2.4*/
 	//source: http://www.openflipper.org/media/Documentation/OpenFlipper-1.3/tutorial_04.html
 	// smooth mesh _iterations times
@@ -25,21 +227,140 @@ void SmoothUniformLaplacian(HEMesh& m, float lamda, unsigned int iterations, Ope
 	}
 }
 
-void SmoothCotangentLaplacian(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double>atheta, OpenMesh::EPropHandleT<double>btheta){
-	std::cout << "_______________________________________Laplace Smoothing using cotaangent discretization_______________________________________" << std::endl;
+void SmoothCotangentLaplacian(HEMesh& m, float lamda, unsigned int iterations, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, LaplacianMatrix& laplacian, SmoothingScheme scheme){
+    CotanWeight(m, eWeights, laplacian);
 
-    CotanWeight(m, eWeights, atheta, btheta);
-
-    for (unsigned int i=0; i < iterations; ++i)
+    //every task only writes the property or position of its own vertex
+    if (scheme == SmoothingScheme::Jacobi)
     {
-        //First Calculate COG for all Vertices
-        for (auto v_iter = m.vertices_begin(); v_iter != m.vertices_end(); ++v_iter)
-            ComputeCOGCotangent(m, vertexCogProperty, eWeights, atheta, btheta, v_iter.operator*());
+        for (unsigned int i=0; i < iterations; ++i)
+        {
+            //First Calculate COG for all Vertices
+            nse::util::ParallelFor(0, m.n_vertices(), [&](size_t v)
+            {
+                ComputeCOGCotangent(m, vertexCogProperty, eWeights, m.vertex_handle((int)v));
+            });
 
-        // Then set the new position for all vertices
-        for (auto v_iter = m.vertices_begin(); v_iter != m.vertices_end(); ++v_iter)
-            SetNewPosition(m, lamda, vertexCogProperty, v_iter.operator*());
+            // Then set the new position for all vertices
+            nse::util::ParallelFor(0, m.n_vertices(), [&](size_t v)
+            {
+                SetNewPosition(m, lamda, vertexCogProperty, m.vertex_handle((int)v));
+            });
+        }
     }
+    else
+    {
+        MeshAdjacency adjacency;
+        BuildMeshAdjacency(m, adjacency);
+        VertexColoring coloring;
+        ColorVertices(adjacency, coloring);
+        for (unsigned int i = 0; i < iterations; ++i)
+            for (size_t c = 0; c < coloring.NumColors(); ++c)
+                nse::util::ParallelFor(coloring.offsets[c], coloring.offsets[c + 1], [&](size_t j)
+                {
+                    auto v = m.vertex_handle((int)coloring.vertices[j]);
+                    ComputeCOGCotangent(m, vertexCogProperty, eWeights, v);
+                    SetNewPosition(m, lamda, vertexCogProperty, v);
+                });
+    }
+}
+
+bool ImplicitCotangentSmoothing::Factorize(const HEMesh& m, const LaplacianMatrix& laplacian, float lamda)
+{
+	const Eigen::SparseMatrix<double>& L = laplacian.Matrix();
+	size_t n = m.n_vertices();
+	fixed.resize(n);
+	diagonal.resize(n);
+	for (auto v : m.vertices())
+	{
+		double sum = -L.valuePtr()[laplacian.DiagonalEntry(v)];
+		fixed[v.idx()] = m.is_boundary(v) || !(sum > 0);
+		diagonal[v.idx()] = fixed[v.idx()] ? 1 : sum;
+	}
+
+	//both matrices share the pattern of the Laplace matrix, every column is written by one task
+	Eigen::SparseMatrix<double> A = L;
+	fixedCoupling = L;
+	nse::util::ParallelFor(0, n, [&](size_t c)
+	{
+		for (int k = L.outerIndexPtr()[c]; k < L.outerIndexPtr()[c + 1]; ++k)
+		{
+			size_t r = L.innerIndexPtr()[k];
+			double w = L.valuePtr()[k];
+			if (r == c)
+			{
+				A.valuePtr()[k] = fixed[c] ? 1 : (1 + lamda) * diagonal[c];
+				fixedCoupling.valuePtr()[k] = 0;
+			}
+			else
+			{
+				A.valuePtr()[k] = fixed[r] || fixed[c] ? 0 : -lamda * w;
+				fixedCoupling.valuePtr()[k] = !fixed[r] && fixed[c] ? lamda * w : 0;
+			}
+		}
+	});
+
+	solver.compute(A);
+	if (solver.info() != Eigen::Success)
+	{
+		factorizedLamda = 0;
+		return false;
+	}
+	factorizedLamda = lamda;
+	numFaces = m.n_faces();
+	positions.resize(n);
+	for (auto v : m.vertices())
+		positions[v.idx()] = m.point(v);
+	return true;
+}
+
+bool ImplicitCotangentSmoothing::IsFactorizedFor(const HEMesh& m, float lamda) const
+{
+	if (factorizedLamda == 0 || lamda != factorizedLamda || numFaces != m.n_faces() || positions.size() != m.n_vertices())
+		return false;
+	for (auto v : m.vertices())
+		if (std::memcmp(&m.point(v), &positions[v.idx()], sizeof(OpenMesh::Vec3f)) != 0)
+			return false;
+	return true;
+}
+
+void ImplicitCotangentSmoothing::Smooth(HEMesh& m, unsigned int steps)
+{
+	Eigen::MatrixXd x(m.n_vertices(), 3);
+	for (auto v : m.vertices())
+	{
+		auto& p = m.point(v);
+		x.row(v.idx()) << p[0], p[1], p[2];
+	}
+
+	//the fixed vertices contribute a constant term to the right hand side
+	Eigen::MatrixXd fixedTerm = fixedCoupling * x;
+	for (unsigned int i = 0; i < steps; ++i)
+	{
+		Eigen::MatrixXd rhs = diagonal.asDiagonal() * x + fixedTerm;
+		x = solver.solve(rhs);
+	}
+
+	for (auto v : m.vertices())
+	{
+		if (!fixed[v.idx()])
+			m.set_point(v, OpenMesh::Vec3f((float)x(v.idx(), 0), (float)x(v.idx(), 1), (float)x(v.idx(), 2)));
+		positions[v.idx()] = m.point(v);
+	}
+}
+
+void SmoothCotangentLaplacianImplicit(HEMesh& m, float lamda, unsigned int steps, LaplacianMatrix& laplacian, ImplicitCotangentSmoothing& smoothing)
+{
+	if (!smoothing.IsFactorizedFor(m, lamda))
+	{
+		laplacian.UpdateWeights(m, LaplacianWeights::Cotangent);
+		if (!smoothing.Factorize(m, laplacian, lamda))
+		{
+			std::cout << "The implicit smoothing system could not be factorized." << std::endl;
+			return;
+		}
+	}
+	smoothing.Smooth(m, steps);
 }
 
 void ComputeCOG(HEMesh &m, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::VertexHandle vertexHandle) {
@@ -55,7 +376,7 @@ void ComputeCOG(HEMesh &m, OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProp
 }
 
 //Source: http://graphics.stanford.edu/courses/cs468-12-spring/LectureSlides/06_smoothing.pdf
-void ComputeCOGCotangent(HEMesh &m,  OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double> atheta, OpenMesh::EPropHandleT<double> btheta, OpenMesh::VertexHandle vertexHandle) {
+void ComputeCOGCotangent(HEMesh &m,  OpenMesh::VPropHandleT<OpenMesh::Vec3f> vertexCogProperty, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::VertexHandle vertexHandle) {
     double valence = 0, weight=0;
     OpenMesh::HalfedgeHandle h0, h1;
     OpenMesh::Vec3f cog = OpenMesh::Vec3f( 0.0f, 0.0f, 0.0f),  p0 = OpenMesh::Vec3f( 0.0f, 0.0f, 0.0f), p1 = OpenMesh::Vec3f( 0.0f, 0.0f, 0.0f);
@@ -73,10 +394,17 @@ void ComputeCOGCotangent(HEMesh &m,  OpenMesh::VPropHandleT<OpenMesh::Vec3f> ver
     m.property(vertexCogProperty, vertexHandle) = (cog);
 }
 
-void CotanWeight(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double>atheta, OpenMesh::EPropHandleT<double>btheta) {
-    double weight, a, b, c, d;
+void CotanWeight(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, LaplacianMatrix& laplacian)
+{
+	laplacian.UpdateWeights(mesh, LaplacianWeights::Cotangent);
+	for (auto e : mesh.edges())
+		mesh.property(eWeights, e) = laplacian.EdgeWeights()[e.idx()];
+}
+
+void CotanWeightFromAngles(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, OpenMesh::EPropHandleT<double>atheta, OpenMesh::EPropHandleT<double>btheta) {
+    double weight, a, b;
     OpenMesh::HalfedgeHandle pi_pj, pj_pi, pj_pj_minus_1, pj_pj_plus_1;
-    OpenMesh::Vec3f p0, p1, p2, d0, d1, p_i, p_j, p_j_minus_1, p_j_plus_1;
+    OpenMesh::Vec3f d0, d1, p_i, p_j, p_j_minus_1, p_j_plus_1;
     const float pi = 3.14159265359f;
 
     for (OpenMesh::PolyConnectivity::EdgeIter e_it = mesh.edges_begin(); e_it != mesh.edges_end(); ++e_it) {
@@ -91,22 +419,14 @@ void CotanWeight(HEMesh& mesh, OpenMesh::EPropHandleT<double> eWeights, OpenMesh
         p_j_minus_1 = mesh.point(mesh.to_vertex_handle(pj_pj_minus_1));
         d0 = (p_i - p_j_minus_1); d0.normalize();
         d1 = (p_j - p_j_minus_1); d1.normalize();
-        c = acos(dot((p_i-p_j).normalize(), (p_j_minus_1 - p_j).normalize()));
-        d = acos(dot((p_j-p_i).normalize(), (p_j_minus_1 - p_i).normalize()));
         a = acos(dot(d0, d1));
-        if(a > pi / 2 || c > pi / 2 || d > pi / 2)
-            std::cout << "obtuse triangle" << std::endl;
         weight += 1.0f / tan(a);
 
         pj_pj_plus_1 = mesh.next_halfedge_handle(pj_pi);
         p_j_plus_1 = mesh.point(mesh.to_vertex_handle(pj_pj_plus_1));
         d0 = (p_i - p_j_plus_1); d0.normalize();
         d1 = (p_j - p_j_plus_1); d1.normalize();
-        c = acos(dot((p_i-p_j).normalize(), (p_j_plus_1 - p_j).normalize()));
-        d = acos(dot((p_j-p_i).normalize(), (p_j_plus_1 - p_i).normalize()));
         b = acos(dot(d0, d1));
-        if(b > pi / 2 || c > pi / 2 || d > pi / 2)
-            std::cout << "obtuse triangle" << std::endl;
         weight += 1.0f / tan(b);
 
         mesh.property(eWeights, *e_it) = weight;
@@ -128,15 +448,17 @@ void AddNoise(HEMesh& m)
 	std::mt19937 rnd;
 	std::normal_distribution<float> dist;
 
+	//all vertices are displaced along the normals of the unperturbed mesh
+	std::vector<Eigen::Vector3f> normals;
+	ComputeVertexNormals(m, normals);
 	for (auto v : m.vertices())
 	{
-		OpenMesh::Vec3f n;
-		m.calc_vertex_normal_correct(v, n); //normal scales with area
+		Eigen::Vector3f n = normals[v.idx()]; //normal scales with area
 		float areaScale = n.norm();
 		float lengthScale = sqrt(areaScale);
 		n = lengthScale / areaScale * n;
 
-		m.point(v) += 0.1f * dist(rnd) * n;
+		m.point(v) += 0.1f * dist(rnd) * ToOpenMeshVector(n);
 	}
 }
 
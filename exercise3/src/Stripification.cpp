@@ -4,15 +4,34 @@
 
 #include "Stripification.h"
 
+#include <algorithm>
 #include <random>
 #include <Stripification.h>
 #include <iostream>
+#include <vector>
+
+#include <util/Parallel.h>
 
 #include "sample_set.h"
 
+//scratch memory of one thread for the evaluation of the trials
+template <typename FaceSet>
+struct StripTrialScratch
+{
+	FaceSet candidate, best;
+	//index of the seed of best in seed_pointers
+	size_t bestSeed;
+};
+
+
+static unsigned int ExtractTriStripsDegreePriority(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty);
 
-unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials)
+template <typename FaceSet>
+unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials, StripificationMode mode)
 {
+	if (mode == StripificationMode::DegreePriority)
+		return ExtractTriStripsDegreePriority(mesh, perFaceStripIdProperty);
+
 	//prepare random engine
 	std::mt19937 eng;
 
@@ -20,7 +39,18 @@ unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceS
 
 	/*Task 2.2.5*/
 
-	sample_set<OpenMesh::FaceHandle> unassigned_triangles; // Set of not yet assigned triangles (index -1)
+	FaceSet unassigned_triangles; // Set of not yet assigned triangles (index -1)
+	unassigned_triangles.reserve(mesh.n_faces());
+	//the sets are reused for all strips and trials, clear() only touches their elements
+	FaceSet seed_pointers;
+	seed_pointers.reserve(mesh.n_faces());
+	auto& pool = nse::util::ThreadPool::Instance();
+	std::vector<StripTrialScratch<FaceSet>> scratch(pool.NumThreads());
+	for (auto& s : scratch)
+	{
+		s.candidate.reserve(mesh.n_faces());
+		s.best.reserve(mesh.n_faces());
+	}
 	//initialize strip index to -1 for each face
 	for (auto f : mesh.faces()){
 		mesh.property(perFaceStripIdProperty, f) = -1;
@@ -32,12 +62,13 @@ unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceS
 	// If there are no more triangles in the triangulation then exit.
 	while (!unassigned_triangles.empty()){
 		//randomly select 𝑘=nTrials seed pointers inside not yet assigned triangles (index -1)
-		sample_set<OpenMesh::FaceHandle> seed_pointers;
+		seed_pointers.clear();
 		for (int i = 0; i < nTrials; ++i) {
 			seed_pointers.insert(unassigned_triangles.sample(eng));
 		}
 
-		sample_set<OpenMesh::FaceHandle> triangle_strip;
+		for (auto& s : scratch)
+			s.best.clear();
 
 		//from each seed, determine maximum strip length stepping forward &  backward
         /*
@@ -46,11 +77,29 @@ unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceS
          *  As a result the number of seed pointers can be less than nTrials.
          *  If iteration is held over nTrials instead of seed_pointers.size() this will result in an error, because invalid pointers are used for the face.
          */
-		for (int j = 0; j < seed_pointers.size(); ++j) {
-			sample_set<OpenMesh::FaceHandle> calculatedTriangleStrip = calculateTriangleStrip(mesh, perFaceStripIdProperty, seed_pointers.elements[j]);
-			if (calculatedTriangleStrip.size() > triangle_strip.size()) // and select longest strip (greedy choice)
-				triangle_strip = calculatedTriangleStrip;
-		}
+		//the walks only read the mesh and are evaluated in parallel, every thread keeps the longest of its strips
+		auto evaluateTrial = [&](size_t j, unsigned int thread)
+		{
+			auto& s = scratch[thread];
+			calculateTriangleStrip(mesh, perFaceStripIdProperty, seed_pointers.elements[j], s.candidate);
+			// and select longest strip (greedy choice), ties go to the first seed like in a serial loop
+			if (s.candidate.size() > s.best.size() || (s.candidate.size() == s.best.size() && j < s.bestSeed))
+			{
+				std::swap(s.best, s.candidate);
+				s.bestSeed = j;
+			}
+		};
+		if (seed_pointers.size() > 1 && scratch.size() > 1)
+			pool.Run(seed_pointers.size(), evaluateTrial);
+		else
+			for (size_t j = 0; j < seed_pointers.size(); ++j)
+				evaluateTrial(j, 0);
+
+		StripTrialScratch<FaceSet>* winner = &scratch[0];
+		for (auto& s : scratch)
+			if (s.best.size() > winner->best.size() || (s.best.size() == winner->best.size() && !s.best.empty() && s.bestSeed < winner->bestSeed))
+				winner = &s;
+		auto& triangle_strip = winner->best;
 
 		//allocate new strip index
 		stripId++;
@@ -65,9 +114,10 @@ unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceS
 	return nStrips;
 }
 
-sample_set<OpenMesh::FaceHandle> calculateTriangleStrip(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, OpenMesh::FaceHandle seed_pointer)
+template <typename FaceSet>
+void calculateTriangleStrip(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, OpenMesh::FaceHandle seed_pointer, FaceSet& triangle_strip)
 {
-    sample_set<OpenMesh::FaceHandle> triangle_strip; //triangle set which was sampled
+    triangle_strip.clear(); //triangle set which was sampled
 
     OpenMesh::HalfedgeHandle halfedgeHandle; //initial HalfEdge as start of triangle strip
         // iterator over all halfEdges of the triangle face
@@ -100,8 +150,7 @@ sample_set<OpenMesh::FaceHandle> calculateTriangleStrip(HEMesh& mesh, OpenMesh::
                             halfedgeHandle); // get the new face connected trough the HalfEdge
                     //if the face was already assigned to another triangle strip
                     if (mesh.property(perFaceStripIdProperty, faceHandle) != -1 ||
-                        !(triangle_strip.index_lut.find(faceHandle) ==
-                          triangle_strip.index_lut.end())) {// this is the end of the triangle strip in the forward direction
+                        triangle_strip.contains(faceHandle)) {// this is the end of the triangle strip in the forward direction
                         direction = !direction; // change direction to go backwards
                         halfedgeHandle = mesh.fh_begin(
                                 seed_pointer).operator*(); //set initial HalfEdge back to seed pointer
@@ -120,7 +169,7 @@ sample_set<OpenMesh::FaceHandle> calculateTriangleStrip(HEMesh& mesh, OpenMesh::
                             halfedgeHandle); // get the new face connected trough the HalfEdge
                     //if the face was already assigned to another triangle strip
                     if (mesh.property(perFaceStripIdProperty, faceHandle) != -1 ||
-                        !(triangle_strip.index_lut.find(faceHandle) == triangle_strip.index_lut.end()))
+                        triangle_strip.contains(faceHandle))
                         hasNeighbors = false;// this is the end of the triangle strip
                     else {
                         triangle_strip.insert(faceHandle); // assign it to triangle strip
@@ -128,7 +177,145 @@ sample_set<OpenMesh::FaceHandle> calculateTriangleStrip(HEMesh& mesh, OpenMesh::
                 }
             }
         }
-    return triangle_strip;
+}
+
+template unsigned int ExtractTriStrips<sample_set<OpenMesh::FaceHandle>>(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials, StripificationMode mode);
+template unsigned int ExtractTriStrips<hashed_sample_set<OpenMesh::FaceHandle>>(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials, StripificationMode mode);
+template void calculateTriangleStrip(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, OpenMesh::FaceHandle seed_pointer, sample_set<OpenMesh::FaceHandle>& triangle_strip);
+template void calculateTriangleStrip(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, OpenMesh::FaceHandle seed_pointer, hashed_sample_set<OpenMesh::FaceHandle>& triangle_strip);
+
+//Walks a strip that leaves its current face through the halfedge exit. exitIsNext tells if exit is the next
+//(true) or the previous (false) halfedge of the entry of the current face, the following faces alternate between
+//both turns. available(f) decides if a face may be added, visit(f) is called for every added face.
+//Returns the number of added faces, swaps counts the turns that had to repeat the previous one.
+template <typename Available, typename Visit>
+static size_t WalkStrip(const HEMesh& mesh, OpenMesh::HalfedgeHandle exit, bool exitIsNext, Available&& available, Visit&& visit, size_t& swaps)
+{
+	auto canEnter = [&](OpenMesh::HalfedgeHandle h)
+	{
+		auto o = mesh.opposite_halfedge_handle(h);
+		return !mesh.is_boundary(o) && available(mesh.face_handle(o));
+	};
+
+	size_t count = 0;
+	while (canEnter(exit))
+	{
+		auto entry = mesh.opposite_halfedge_handle(exit);
+		visit(mesh.face_handle(entry));
+		++count;
+
+		//alternate the turn, swap if the alternating turn is blocked but the other one is not
+		exitIsNext = !exitIsNext;
+		exit = exitIsNext ? mesh.next_halfedge_handle(entry) : mesh.prev_halfedge_handle(entry);
+		if (!canEnter(exit))
+		{
+			auto other = exitIsNext ? mesh.prev_halfedge_handle(entry) : mesh.next_halfedge_handle(entry);
+			if (canEnter(other))
+			{
+				exit = other;
+				exitIsNext = !exitIsNext;
+				++swaps;
+			}
+		}
+	}
+	return count;
+}
+
+static unsigned int ExtractTriStripsDegreePriority(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty)
+{
+	//number of unassigned neighbors of every face
+	std::vector<unsigned int> degree(mesh.n_faces(), 0);
+	//buckets[d] contains faces with degree d, entries become stale when the degree of a face drops or it is assigned
+	std::vector<std::vector<OpenMesh::FaceHandle>> buckets;
+	for (auto f : mesh.faces())
+	{
+		mesh.property(perFaceStripIdProperty, f) = -1;
+		for (auto h : mesh.fh_range(f))
+			if (!mesh.is_boundary(mesh.opposite_halfedge_handle(h)))
+				++degree[f.idx()];
+		if (degree[f.idx()] >= buckets.size())
+			buckets.resize(degree[f.idx()] + 1);
+		buckets[degree[f.idx()]].push_back(f);
+	}
+	//faces are visited in reverse order from the buckets, this makes the first strip start at the first face
+	for (auto& bucket : buckets)
+		std::reverse(bucket.begin(), bucket.end());
+
+	//faces of the current walk are marked with the current stamp, such that a strip does not run into itself
+	std::vector<unsigned int> stamps(mesh.n_faces(), 0);
+	unsigned int stamp = 0;
+	auto available = [&](OpenMesh::FaceHandle f)
+	{
+		return mesh.property(perFaceStripIdProperty, f) == -1 && stamps[f.idx()] != stamp;
+	};
+	auto mark = [&](OpenMesh::FaceHandle f) { stamps[f.idx()] = stamp; };
+
+	size_t minBucket = 0;
+	int stripId = -1;
+	while (true)
+	{
+		//pop the unassigned face with the lowest degree, skipping stale entries
+		OpenMesh::FaceHandle seed;
+		while (minBucket < buckets.size() && !seed.is_valid())
+		{
+			auto& bucket = buckets[minBucket];
+			if (bucket.empty())
+			{
+				++minBucket;
+				continue;
+			}
+			auto f = bucket.back();
+			bucket.pop_back();
+			if (mesh.property(perFaceStripIdProperty, f) == -1 && degree[f.idx()] == minBucket)
+				seed = f;
+		}
+		if (!seed.is_valid())
+			break;
+
+		//count the length of the strip in every direction through the seed
+		OpenMesh::HalfedgeHandle bestExit;
+		size_t bestLength = 0, bestSwaps = 0;
+		for (auto h : mesh.fh_range(seed))
+		{
+			++stamp;
+			mark(seed);
+			size_t swaps = 0;
+			size_t length = 1 + WalkStrip(mesh, h, true, available, mark, swaps)
+				+ WalkStrip(mesh, mesh.prev_halfedge_handle(h), false, available, mark, swaps);
+			if (length > bestLength || (length == bestLength && swaps < bestSwaps))
+			{
+				bestExit = h;
+				bestLength = length;
+				bestSwaps = swaps;
+			}
+		}
+
+		//walk the best direction again and assign the faces
+		++stripId;
+		auto assign = [&](OpenMesh::FaceHandle f)
+		{
+			mark(f);
+			mesh.property(perFaceStripIdProperty, f) = stripId;
+			for (auto h : mesh.fh_range(f))
+			{
+				auto o = mesh.opposite_halfedge_handle(h);
+				if (mesh.is_boundary(o))
+					continue;
+				auto g = mesh.face_handle(o);
+				if (mesh.property(perFaceStripIdProperty, g) != -1)
+					continue;
+				unsigned int d = --degree[g.idx()];
+				buckets[d].push_back(g);
+				minBucket = std::min<size_t>(minBucket, d);
+			}
+		};
+		++stamp;
+		size_t swaps = 0;
+		assign(seed);
+		WalkStrip(mesh, bestExit, true, available, assign, swaps);
+		WalkStrip(mesh, mesh.prev_halfedge_handle(bestExit), false, available, assign, swaps);
+	}
+	return (unsigned int)(stripId + 1);
 }
 
 OpenMesh::HalfedgeHandle goForwards(HEMesh& mesh, OpenMesh::HalfedgeHandle hi, bool parity) {
@@ -4,8 +4,6 @@
 
 #include "SurfaceArea.h"
 
-#include <iostream>
-
 float ComputeSurfaceArea(const HEMesh& m)
 {
 	float area = 0;
@@ -16,8 +14,6 @@ float ComputeSurfaceArea(const HEMesh& m)
 				f_it=m.faces_begin();
 				f_it!=m.faces_end();
 				++f_it){
-		std::cout << "Iterating over Face " << f_it.operator*().idx() << std::endl;
-
 		auto normal = m.calc_face_normal(f_it.operator*());
 
 		// iterator over all halfedges of a face
@@ -28,7 +24,6 @@ float ComputeSurfaceArea(const HEMesh& m)
 		{
 			auto from = m.point(m.from_vertex_handle(fh_iter.operator*()));
 			auto to = m.point(m.to_vertex_handle(fh_iter.operator*()));
-			std::cout << "Iterating over Halfedge from: " << from << " to " << to << std::endl;
 			area += OpenMesh::dot(OpenMesh::cross(from, to)/2, normal);
 		}
 	}
@@ -24,6 +24,7 @@
 #include "ShellExtraction.h"
 #include "Smoothing.h"
 #include "Stripification.h"
+#include "Benchmarks.h"
 
 const int segmentColorCount = 12;
 const float segmentColors[segmentColorCount][3] =
@@ -52,8 +53,6 @@ Viewer::Viewer()
 	polymesh.add_property(faceIdProperty);
 	polymesh.add_property(faceColorProperty);
 	polymesh.add_property(vertexCogProperty);
-	polymesh.add_property(atheta);
-	polymesh.add_property(btheta);
 	polymesh.add_property(eWeights);
 }
 
@@ -144,6 +143,7 @@ void Viewer::SetupGUI()
 
 	auto extractShellsBtn = new nanogui::Button(mainWindow, "Extract Shells");
 	extractShellsBtn->setCallback([this]() {
+		hasStrips = false;
 		auto count = ExtractShells(polymesh, faceIdProperty);
 		std::stringstream ss;
 		ss << "The mesh has " << count << " shells.";
@@ -154,7 +154,7 @@ void Viewer::SetupGUI()
 	});
 
 	auto noiseBtn = new nanogui::Button(mainWindow, "Add Noise");
-	noiseBtn->setCallback([this]() { AddNoise(polymesh); MeshUpdated(); });
+	noiseBtn->setCallback([this]() { AddNoise(polymesh); renderer.UpdateGeometry(); });
 
 	nanogui::TextBox* txtSmoothingIterations;
 	auto sldSmoothingIterations = nse::gui::AddLabeledSlider(mainWindow, "Smoothing Iterations", std::make_pair(1, 100), 20, txtSmoothingIterations);
@@ -167,19 +167,38 @@ void Viewer::SetupGUI()
 
 	sldSmoothingStrength = nse::gui::AddLabeledSliderWithDefaultDisplay(mainWindow, "Smoothing Strength", std::make_pair(0.0f, 1.0f), 0.1f, 2);
 
+	smoothingSchemeBtn = new nanogui::ComboBox(mainWindow, { "Jacobi", "Colored Gauss-Seidel" });
+
+	sldSmoothingTolerance = nse::gui::AddLabeledSliderWithDefaultDisplay(mainWindow, "Residual Reduction", std::make_pair(0.0001f, 0.1f), 0.01f, 4);
+
 
 	auto smoothBtn = new nanogui::Button(mainWindow, "Laplacian Smoothing");
 	smoothBtn->setCallback([this]() {
-		SmoothUniformLaplacian(polymesh, sldSmoothingStrength->value(), smoothingIterations, vertexCogProperty);
-		MeshUpdated();
+		SmoothUniformLaplacian(polymesh, sldSmoothingStrength->value(), smoothingIterations, (SmoothingScheme)smoothingSchemeBtn->selectedIndex());
+		renderer.UpdateGeometry();
 	});
 
     auto smoothBtnLaplaceBeltrami = new nanogui::Button(mainWindow, "Smoothing Using Cotangents");
 	smoothBtnLaplaceBeltrami->setCallback([this]() {
-		SmoothCotangentLaplacian(polymesh, sldSmoothingStrength->value(), smoothingIterations, vertexCogProperty, eWeights, atheta, btheta);
-        MeshUpdated();
+		SmoothCotangentLaplacian(polymesh, sldSmoothingStrength->value(), smoothingIterations, vertexCogProperty, eWeights, laplacian, (SmoothingScheme)smoothingSchemeBtn->selectedIndex());
+        renderer.UpdateGeometry();
     });
 
+	auto convergedSmoothBtn = new nanogui::Button(mainWindow, "Smoothing Until Converged");
+	convergedSmoothBtn->setCallback([this]() {
+		auto statistics = SmoothUniformLaplacianToTolerance(polymesh, sldSmoothingStrength->value(), sldSmoothingTolerance->value(), 100000, SmoothingAcceleration::Chebyshev);
+		std::cout << "Smoothing " << (statistics.converged ? "converged" : "did not converge") << " after " << statistics.sweeps << " sweeps." << std::endl;
+		renderer.UpdateGeometry();
+	});
+
+	auto implicitSmoothBtn = new nanogui::Button(mainWindow, "Implicit Smoothing Using Cotangents");
+	implicitSmoothBtn->setCallback([this]() {
+		//a single backward Euler step that covers the same time as the explicit iterations, the factorization is
+		//reused for repeated clicks as long as the mesh is not changed otherwise
+		SmoothCotangentLaplacianImplicit(polymesh, sldSmoothingStrength->value() * smoothingIterations, 1, laplacian, implicitSmoothing);
+		renderer.UpdateGeometry();
+	});
+
 	nanogui::TextBox* txtStripificationTrials;
 	auto sldStripificationTrials = nse::gui::AddLabeledSlider(mainWindow, "Stripification Trials", std::make_pair(1, 50), 20, txtStripificationTrials);
 	sldStripificationTrials->setCallback([this, txtStripificationTrials](float value)
@@ -189,8 +208,11 @@ void Viewer::SetupGUI()
 	});
 	sldStripificationTrials->callback()(sldStripificationTrials->value());
 
+	stripificationModeBtn = new nanogui::ComboBox(mainWindow, { "Random Trials", "Degree Priority" });
+
 	auto stripifyBtn = new nanogui::Button(mainWindow, "Extract Triangle Strips");
 	stripifyBtn->setCallback([this]() {
+		hasStrips = false;
 		//Triangulate the mesh if it is not a triangle mesh
 		for (auto f : polymesh.faces())
 		{
@@ -203,17 +225,134 @@ void Viewer::SetupGUI()
 			}
 		}
 
-		auto count = ExtractTriStrips(polymesh, faceIdProperty, stripificationTrials);
+		auto count = ExtractTriStrips(polymesh, faceIdProperty, stripificationTrials, (StripificationMode)stripificationModeBtn->selectedIndex());
 		std::stringstream ss;
 		ss << "The mesh has " << count << " triangle strips.";
 		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Shell Extraction",
 			ss.str());
 
+		hasStrips = true;
 		ColorMeshFromIds();
 	});
 
+	//strips are rendered without the face colors
+	chkRenderStrips = new nanogui::CheckBox(mainWindow, "Render Triangle Strips", [this](bool) { MeshUpdated(); });
+
+	auto benchmarkBtn = new nanogui::PopupButton(mainWindow, "Benchmarks");
+	benchmarkBtn->popup()->setLayout(new nanogui::BoxLayout(nanogui::Orientation::Vertical, nanogui::Alignment::Fill, 4, 4));
+
+	auto integralsBtn = new nanogui::Button(benchmarkBtn->popup(), "Mesh Integrals");
+	integralsBtn->setCallback([this]() {
+		//ComputeVolume is restricted to triangle meshes
+		for (auto f : polymesh.faces())
+		{
+			if (polymesh.valence(f) > 3)
+			{
+				std::cout << "Triangulating mesh." << std::endl;
+				polymesh.triangulate();
+				MeshUpdated();
+				break;
+			}
+		}
+		BenchmarkMeshIntegrals(polymesh);
+	});
+
+	auto smoothingBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Laplacian Smoothing");
+	smoothingBenchmarkBtn->setCallback([this]() {
+		BenchmarkSmoothing(polymesh, sldSmoothingStrength->value(), smoothingIterations);
+	});
+
+	auto implicitBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Implicit Smoothing");
+	implicitBenchmarkBtn->setCallback([this]() {
+		BenchmarkImplicitSmoothing(polymesh, sldSmoothingStrength->value(), smoothingIterations);
+	});
+
+	auto toleranceBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Smoothing Until Converged");
+	toleranceBenchmarkBtn->setCallback([this]() {
+		BenchmarkSmoothingToTolerance(polymesh, sldSmoothingStrength->value(), sldSmoothingTolerance->value());
+	});
+
+	auto shellBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Shell Extraction");
+	shellBenchmarkBtn->setCallback([this]() {
+		BenchmarkShellExtraction(polymesh);
+	});
+
+	auto unionFindBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Union-Find");
+	unionFindBenchmarkBtn->setCallback([this]() {
+		BenchmarkUnionFind();
+	});
+
+	auto stripificationBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Stripification");
+	stripificationBenchmarkBtn->setCallback([this]() {
+		BenchmarkStripification(polymesh, stripificationTrials);
+	});
+
+	auto stripRenderingBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Strip Rendering");
+	stripRenderingBenchmarkBtn->setCallback([this]() { CompareStripRendering(); });
+
+	auto vertexCacheBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Vertex Cache");
+	vertexCacheBenchmarkBtn->setCallback([this]() {
+		BenchmarkVertexCache(polymesh);
+	});
+
+	auto rendererBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Renderer Updates");
+	rendererBenchmarkBtn->setCallback([this]() {
+		BenchmarkRendererUpdates(polymesh, sldSmoothingStrength->value());
+	});
+
+	auto vertexFormatBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Vertex Formats");
+	vertexFormatBenchmarkBtn->setCallback([this]() {
+		BenchmarkVertexFormats(polymesh);
+	});
+
+	auto vertexNormalBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Vertex Normals");
+	vertexNormalBenchmarkBtn->setCallback([this]() {
+		BenchmarkVertexNormals(polymesh);
+	});
+
+	auto passTimesBtn = new nanogui::Button(benchmarkBtn->popup(), "GPU Pass Times");
+	passTimesBtn->setCallback([this]() {
+		auto& times = renderer.PassTimes();
+		std::cout << (renderPathBtn->selectedIndex() == (int)RenderPath::Deferred ? "Deferred" : "Forward") << " rendering: geometry pass "
+			<< times.geometry << " ms, SSAO pass " << times.ssao << " ms, lighting pass " << times.lighting << " ms" << std::endl;
+	});
+
+	auto spatialOrderBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Spatial Order");
+	spatialOrderBenchmarkBtn->setCallback([this]() {
+		BenchmarkSpatialOrder(polymesh, sldSmoothingStrength->value(), smoothingIterations);
+	});
+
+	auto sampleSetBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Sample Sets");
+	sampleSetBenchmarkBtn->setCallback([this]() {
+		BenchmarkSampleSets(polymesh, stripificationTrials);
+	});
+
+	auto cotangentBenchmarkBtn = new nanogui::Button(benchmarkBtn->popup(), "Cotangent Weights");
+	cotangentBenchmarkBtn->setCallback([this]() {
+		BenchmarkCotangentWeights(polymesh);
+	});
+
 	shadingBtn = new nanogui::ComboBox(mainWindow, { "Smooth Shading", "Flat Shading" });
 
+	triangleOrderBtn = new nanogui::ComboBox(mainWindow, { "Mesh Triangle Order", "Vertex Cache Order", "Vertex Cache + Overdraw Order" });
+	triangleOrderBtn->setCallback([this](int index) {
+		renderer.SetTriangleOrder((TriangleOrder)index);
+		MeshUpdated();
+	});
+
+	vertexFormatBtn = new nanogui::ComboBox(mainWindow, { "Float Vertices", "Packed Vertices", "Quantized Vertices" });
+	vertexFormatBtn->setCallback([this](int index) {
+		renderer.SetVertexFormat((VertexFormat)index);
+		renderer.UpdateGeometry();
+	});
+
+	renderPathBtn = new nanogui::ComboBox(mainWindow, { "Forward Rendering", "Deferred Rendering" });
+	renderPathBtn->setSelectedIndex((int)RenderPath::Deferred);
+	renderer.SetRenderPath(RenderPath::Deferred);
+	renderPathBtn->setCallback([this](int index) {
+		renderer.SetRenderPath((RenderPath)index);
+	});
+
 	performLayout();
 }
 
@@ -240,6 +379,9 @@ void Viewer::MeshUpdated(bool initNewMesh)
 	if (initNewMesh)
 	{
 		hasColors = false;
+		hasStrips = false;
+		laplacian.Clear();
+		renderer.ConnectivityChanged();
 
 		//calculate the bounding box of the mesh
 		nse::math::BoundingBox<float, 3> bbox;
@@ -248,10 +390,56 @@ void Viewer::MeshUpdated(bool initNewMesh)
 		camera().FocusOnBBox(bbox);
 	}	
 
-	if (hasColors)
+	if (hasStrips && chkRenderStrips->checked())
+		renderer.UpdateWithTriangleStrips(faceIdProperty);
+	else if (hasColors)
 		renderer.UpdateWithPerFaceColor(faceColorProperty);
 	else
 		renderer.Update();
+
+	if (initNewMesh)
+	{
+		auto& original = renderer.OriginalCacheStatistics();
+		auto& ordered = renderer.CacheStatistics();
+		std::cout << "Vertex cache: ACMR " << original.acmr << ", ATVR " << original.atvr << " in mesh order, ACMR "
+			<< ordered.acmr << ", ATVR " << ordered.atvr << " in drawn order." << std::endl;
+	}
+}
+
+void Viewer::CompareStripRendering()
+{
+	if (!hasStrips)
+	{
+		std::cout << "Extract triangle strips first." << std::endl;
+		return;
+	}
+
+	Eigen::Matrix4f view, proj;
+	camera().ComputeCameraMatrices(view, proj);
+
+	//the invocations of the triangle list depend on its order, strips only save invocations against an unoptimized order
+	renderer.SetTriangleOrder(TriangleOrder::Original);
+	renderer.Update();
+	auto listInvocations = renderer.CountVertexShaderInvocations(view, proj);
+	renderer.SetTriangleOrder(TriangleOrder::VertexCache);
+	renderer.Update();
+	auto cacheOrderInvocations = renderer.CountVertexShaderInvocations(view, proj);
+	renderer.SetTriangleOrder((TriangleOrder)triangleOrderBtn->selectedIndex());
+	auto stats = renderer.UpdateWithTriangleStrips(faceIdProperty);
+	auto stripInvocations = renderer.CountVertexShaderInvocations(view, proj);
+
+	std::cout << stats.triangles << " triangles in " << stats.strips << " strips with " << stats.swaps << " swaps." << std::endl;
+	std::cout << "Indices: " << stats.triangleListIndices << " as triangle list, " << stats.stripIndices << " as strips ("
+		<< 100.0 * (1.0 - (double)stats.stripIndices / stats.triangleListIndices) << " % saved)" << std::endl;
+	if (listInvocations == 0 || cacheOrderInvocations == 0 || stripInvocations == 0)
+		std::cout << "Vertex shader invocations cannot be counted, GL_ARB_pipeline_statistics_query is not supported." << std::endl;
+	else
+		std::cout << "Vertex shader invocations: " << listInvocations << " as triangle list in mesh order, " << cacheOrderInvocations
+			<< " in vertex cache order, " << stripInvocations << " as strips (" << 100.0 * (1.0 - (double)stripInvocations / listInvocations)
+			<< " % saved against mesh order, " << 100.0 * (1.0 - (double)stripInvocations / cacheOrderInvocations)
+			<< " % against vertex cache order)" << std::endl;
+
+	MeshUpdated();
 }
 
 void Viewer::drawContents()
@@ -261,5 +449,6 @@ void Viewer::drawContents()
 	Eigen::Matrix4f view, proj;
 	camera().ComputeCameraMatrices(view, proj);
 
+	renderer.BeginFrame();
 	renderer.Render(view, proj, shadingBtn->selectedIndex() == 1);
 }
\ No newline at end of file
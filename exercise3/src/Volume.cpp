@@ -4,9 +4,6 @@
 
 #include "Volume.h"
 
-#include <iostream>
-#include <Volume.h>
-
 
 float ComputeVolume(const HEMesh& m)
 {
@@ -17,20 +14,16 @@ float ComputeVolume(const HEMesh& m)
 		 f_it!=m.faces_end();
 		 ++f_it) {
 
-		std::vector<OpenMesh::Vec3f> points(3);
-		int i = 0;
-		// iterator over all vertices of the edge in counter clockwise order, which is important
-		for (OpenMesh::PolyConnectivity::FaceVertexCCWIter fv_ccwit = m.cfv_ccwbegin(*f_it);
-			fv_ccwit!= m.cfv_ccwend(*f_it);
-			++fv_ccwit) {
-			points[i] = m.point(fv_ccwit.operator*());
-			i++;
-		}
-		vol+= SignedVolumeOfTriangle(points);
+		// the three vertices of the triangle in counter clockwise order, which is important
+		auto h = m.halfedge_handle(*f_it);
+		const auto& p0 = m.point(m.from_vertex_handle(h));
+		const auto& p1 = m.point(m.to_vertex_handle(h));
+		const auto& p2 = m.point(m.to_vertex_handle(m.next_halfedge_handle(h)));
+		vol+= SignedVolumeOfTriangle(p0, p1, p2);
 	}
 	return vol;
 }
 
-float SignedVolumeOfTriangle(std::vector<OpenMesh::Vec3f>& points) {
-	return  (1.0f/6.0f) *  OpenMesh::dot(points[0], OpenMesh::cross(points[1], points[2]));
+float SignedVolumeOfTriangle(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const OpenMesh::Vec3f& p2) {
+	return  (1.0f/6.0f) *  OpenMesh::dot(p0, OpenMesh::cross(p1, p2));
 }
@@ -3,13 +3,52 @@
 // Copyright (C) CGV TU Dresden - All Rights Reserved
 
 #include <iostream>
+#include <string>
 
 #include <util/GLDebug.h>
+#include <OpenMesh/Core/IO/MeshIO.hh>
 
 #include "Viewer.h"
+#include "Benchmarks.h"
+
+//runs the benchmarks that do not need an OpenGL context without opening a window
+//returns 1 if the mesh cannot be loaded or a result check failed
+int BenchmarkHeadless(const std::string& meshFile)
+{
+	HEMesh mesh;
+	if (!OpenMesh::IO::read_mesh(mesh, meshFile))
+	{
+		std::cerr << "The specified file could not be loaded" << std::endl;
+		return 1;
+	}
+
+	//the default values of the sliders in the viewer
+	const float lamda = 0.1f;
+	const unsigned int iterations = 20;
+	const unsigned int trials = 20;
+	const double tolerance = 0.01;
+
+	bool passed = BenchmarkMeshIntegrals(mesh);
+	passed = BenchmarkSmoothing(mesh, lamda, iterations) && passed;
+	passed = BenchmarkImplicitSmoothing(mesh, lamda, iterations) && passed;
+	passed = BenchmarkCotangentWeights(mesh) && passed;
+	passed = BenchmarkSmoothingToTolerance(mesh, lamda, tolerance) && passed;
+	passed = BenchmarkShellExtraction(mesh) && passed;
+	passed = BenchmarkUnionFind() && passed;
+	passed = BenchmarkSampleSets(mesh, trials) && passed;
+	passed = BenchmarkStripification(mesh, trials) && passed;
+	passed = BenchmarkVertexCache(mesh) && passed;
+	passed = BenchmarkSpatialOrder(mesh, lamda, iterations) && passed;
+	passed = BenchmarkVertexNormals(mesh) && passed;
+	std::cout << (passed ? "All checks passed." : "Some checks failed.") << std::endl;
+	return passed ? 0 : 1;
+}
 
 int main(int argc, char* argv[])
 {
+	if (argc >= 3 && std::string(argv[1]) == "--benchmark")
+		return BenchmarkHeadless(argv[2]);
+
 	nanogui::init();
 
 	{
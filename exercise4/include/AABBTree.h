@@ -301,7 +301,7 @@ public:
 	//returns true if tree is empty
 	bool Empty() const
 	{
-		return primitives.Empty();
+		return primitives.empty();
 	}
 	
 	//insert a primitive into internal primitive list 
@@ -528,6 +528,139 @@ public:
 		return sqrt(SqrDistance(p));
 	}
 
+	//appends pointers to all primitives whose squared distance to the point q is at most sqrRadius to result
+	void RangeQuery(const Eigen::Vector3f& q, float sqrRadius, std::vector<const Primitive*>& result) const
+	{
+		assert(IsCompleted());
+		if(root == nullptr)
+			return;
+		//depth first traversal, subtrees whose bounds are farther away than the radius are skipped
+		std::vector<const AABBNode*> stack;
+		stack.push_back(root);
+		while(!stack.empty())
+		{
+			const AABBNode* node = stack.back();
+			stack.pop_back();
+			if(node->GetBounds().SqrDistance(q) > sqrRadius)
+				continue;
+			if(node->IsLeaf())
+			{
+				auto leaf = (const AABBLeafNode*)node;
+				auto pend = leaf->end();
+				for(auto pit = leaf->begin(); pit != pend; ++pit)
+					if(pit->SqrDistance(q) <= sqrRadius)
+						result.push_back(&(*pit));
+			}
+			else
+			{
+				auto split = (const AABBSplitNode*)node;
+				stack.push_back(split->Right());
+				stack.push_back(split->Left());
+			}
+		}
+	}
+
+	//returns the primitive with the closest intersection of the ray o + t * d for t in [tMin, tMax] or nullptr if there is none
+	//t, u and v receive the ray parameter and the barycentric coordinates of the intersection
+	//the primitive type must provide the method Intersect(o, d, tMin, tMax, t, u, v)
+	const Primitive* ClosestIntersection(const Eigen::Vector3f& o, const Eigen::Vector3f& d, float tMin, float tMax, float& t, float& u, float& v) const
+	{
+		assert(IsCompleted());
+		if(root == nullptr)
+			return nullptr;
+		Eigen::Vector3f invDir = d.cwiseInverse();
+		const Primitive* best = nullptr;
+		float tEnter;
+		//depth first traversal which visits the nearer child first and skips subtrees behind the closest hit so far
+		//the stack stores the nodes together with the ray parameter at which the ray enters their bounds
+		std::vector<std::pair<float, const AABBNode*>> stack;
+		if(!root->GetBounds().IntersectRay(o, invDir, tMin, tMax, tEnter))
+			return nullptr;
+		stack.push_back(std::make_pair(tEnter, root));
+		while(!stack.empty())
+		{
+			auto entry = stack.back();
+			stack.pop_back();
+			if(entry.first > tMax)
+				continue;
+			if(entry.second->IsLeaf())
+			{
+				auto leaf = (const AABBLeafNode*)entry.second;
+				auto pend = leaf->end();
+				float tHit, uHit, vHit;
+				for(auto pit = leaf->begin(); pit != pend; ++pit)
+					if(pit->Intersect(o, d, tMin, tMax, tHit, uHit, vHit))
+					{
+						tMax = tHit;
+						t = tHit; u = uHit; v = vHit;
+						best = &(*pit);
+					}
+			}
+			else
+			{
+				auto split = (const AABBSplitNode*)entry.second;
+				float tLeft, tRight;
+				bool hitLeft = split->Left()->GetBounds().IntersectRay(o, invDir, tMin, tMax, tLeft);
+				bool hitRight = split->Right()->GetBounds().IntersectRay(o, invDir, tMin, tMax, tRight);
+				if(hitLeft && hitRight && tLeft < tRight)
+				{
+					stack.push_back(std::make_pair(tRight, split->Right()));
+					stack.push_back(std::make_pair(tLeft, split->Left()));
+				}
+				else
+				{
+					if(hitLeft)
+						stack.push_back(std::make_pair(tLeft, split->Left()));
+					if(hitRight)
+						stack.push_back(std::make_pair(tRight, split->Right()));
+				}
+			}
+		}
+		return best;
+	}
+
+	//intersection of a ray with a primitive
+	struct RayHit
+	{
+		//ray parameter and barycentric coordinates as returned by the Intersect method of the primitive
+		float t, u, v;
+		const Primitive* primitive;
+	};
+
+	//appends all intersections of the ray o + t * d for t in [tMin, tMax] to result (unsorted)
+	//the primitive type must provide the method Intersect(o, d, tMin, tMax, t, u, v)
+	void AllIntersections(const Eigen::Vector3f& o, const Eigen::Vector3f& d, float tMin, float tMax, std::vector<RayHit>& result) const
+	{
+		assert(IsCompleted());
+		if(root == nullptr)
+			return;
+		Eigen::Vector3f invDir = d.cwiseInverse();
+		float tEnter, t, u, v;
+		std::vector<const AABBNode*> stack;
+		stack.push_back(root);
+		while(!stack.empty())
+		{
+			const AABBNode* node = stack.back();
+			stack.pop_back();
+			if(!node->GetBounds().IntersectRay(o, invDir, tMin, tMax, tEnter))
+				continue;
+			if(node->IsLeaf())
+			{
+				auto leaf = (const AABBLeafNode*)node;
+				auto pend = leaf->end();
+				for(auto pit = leaf->begin(); pit != pend; ++pit)
+					if(pit->Intersect(o, d, tMin, tMax, t, u, v))
+						result.push_back(RayHit{ t, u, v, &*pit });
+			}
+			else
+			{
+				auto split = (const AABBSplitNode*)node;
+				stack.push_back(split->Right());
+				stack.push_back(split->Left());
+			}
+		}
+	}
+
 
 protected:
 
@@ -78,4 +78,8 @@ public:
 	//returns the euclidean distance between p and the box 
 	float Distance(const Eigen::Vector3f& p) const;
 
+	//returns true if the ray o + t * d intersects the box for a ray parameter t in [tMin, tMax]
+	//invDir contains the component-wise reciprocal of d, tEnter receives the ray parameter at which the ray enters the box
+	bool IntersectRay(const Eigen::Vector3f& o, const Eigen::Vector3f& invDir, float tMin, float tMax, float& tEnter) const;
+
 };
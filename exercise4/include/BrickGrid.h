@@ -0,0 +1,215 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <Eigen/Core>
+#include "Box.h"
+#include "GridUtils.h"
+#include "GridTraverser.h"
+#include "HashGrid.h"
+#include "Triangle.h"
+
+/*
+sparse occupancy grid which stores one bit per grid cell
+cells are grouped into bricks of 8 x 8 x 8 cells which are only allocated if at least one of their cells is occupied
+the bricks are stored in a hash map with the brick index as key
+*/
+class BrickOccupancyGrid
+{
+public:
+	//number of cells of a brick along each axis
+	static const int BrickSize = 8;
+
+	//occupancy bits of a brick, word z contains the bits of the cells (x, y, z) at position x + 8 * y
+	typedef std::array<std::uint64_t, BrickSize> Brick;
+
+	//type of internal hash map
+	typedef std::unordered_map<Eigen::Vector3i, Brick, CellIndexHash> BrickHashMapType;
+
+private:
+	BrickHashMapType bricks;
+	Eigen::Vector3f cellExtents;
+	size_t occupiedCells;
+	//inclusive range of the indices of all allocated bricks
+	Eigen::Vector3i lowerBrick, upperBrick;
+
+	//returns the index of the brick that contains the cell idx
+	static Eigen::Vector3i BrickIndex(const Eigen::Vector3i& idx)
+	{
+		//arithmetic shift, rounds towards negative infinity
+		return Eigen::Vector3i(idx[0] >> 3, idx[1] >> 3, idx[2] >> 3);
+	}
+
+	//returns the bit of cell idx within its brick word
+	static std::uint64_t CellBit(const Eigen::Vector3i& idx)
+	{
+		return std::uint64_t(1) << ((idx[0] & 7) + 8 * (idx[1] & 7));
+	}
+
+	//returns the index of the lowest set bit of a non-zero word
+	static int LowestBit(std::uint64_t word)
+	{
+#if defined(_MSC_VER)
+		unsigned long bit;
+		_BitScanForward64(&bit, word);
+		return (int)bit;
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+public:
+	//constructs an empty occupancy grid with the given cell extents
+	BrickOccupancyGrid(const Eigen::Vector3f& cellExtents = Eigen::Vector3f::Constant(0.01f));
+
+	//returns the extents of a grid cell
+	Eigen::Vector3f CellExtents() const { return cellExtents; }
+
+	//converts a position to a grid index
+	Eigen::Vector3i PositionToIndex(const Eigen::Vector3f& pos) const { return PositionToCellIndex(pos, cellExtents); }
+
+	//returns bounding box of cell with index idx
+	Box CellBounds(const Eigen::Vector3i& idx) const;
+
+	//returns the bounding box of the brick with index brickIdx
+	Box BrickBounds(const Eigen::Vector3i& brickIdx) const;
+
+	//marks the cell idx as occupied
+	void SetOccupied(const Eigen::Vector3i& idx);
+
+	//returns true if the cell idx is occupied
+	bool Occupied(const Eigen::Vector3i& idx) const;
+
+	//marks all cells that overlap the primitive as occupied
+	//the primitive must provide the methods ComputeBounds() and Overlaps(const Box&)
+	//the overlap is tested for each brick first, such that the cells of non-overlapping bricks are skipped
+	template <typename Primitive>
+	void Insert(const Primitive& p)
+	{
+		Box b = p.ComputeBounds();
+		if (b.LowerBound()[0] > b.UpperBound()[0] || b.LowerBound()[1] > b.UpperBound()[1] || b.LowerBound()[2] > b.UpperBound()[2])
+			return;
+		Eigen::Vector3i lb = PositionToIndex(b.LowerBound());
+		Eigen::Vector3i ub = PositionToIndex(b.UpperBound());
+		Eigen::Vector3i lbBrick = BrickIndex(lb), ubBrick = BrickIndex(ub);
+		bool singleBrick = lbBrick == ubBrick;
+
+		Eigen::Vector3i brickIdx, idx;
+		for (brickIdx[0] = lbBrick[0]; brickIdx[0] <= ubBrick[0]; ++brickIdx[0])
+			for (brickIdx[1] = lbBrick[1]; brickIdx[1] <= ubBrick[1]; ++brickIdx[1])
+				for (brickIdx[2] = lbBrick[2]; brickIdx[2] <= ubBrick[2]; ++brickIdx[2])
+				{
+					if (!singleBrick && !p.Overlaps(BrickBounds(brickIdx)))
+						continue;
+					Eigen::Vector3i first = (brickIdx * BrickSize).cwiseMax(lb);
+					Eigen::Vector3i last = (brickIdx * BrickSize + Eigen::Vector3i::Constant(BrickSize - 1)).cwiseMin(ub);
+					for (idx[0] = first[0]; idx[0] <= last[0]; ++idx[0])
+						for (idx[1] = first[1]; idx[1] <= last[1]; ++idx[1])
+							for (idx[2] = first[2]; idx[2] <= last[2]; ++idx[2])
+								if (p.Overlaps(CellBounds(idx)))
+									SetOccupied(idx);
+				}
+	}
+
+	//removes all cells
+	void Clear();
+
+	//returns the number of occupied cells
+	size_t NumOccupiedCells() const { return occupiedCells; }
+
+	//returns the number of allocated bricks
+	size_t NumBricks() const { return bricks.size(); }
+
+	//returns the inclusive range of the indices of the cells of all allocated bricks
+	//every occupied cell lies in this range, the range is empty (lower > upper) if the grid is empty
+	void AllocatedCellRange(Eigen::Vector3i& lower, Eigen::Vector3i& upper) const
+	{
+		if (bricks.empty())
+		{
+			lower = Eigen::Vector3i::Zero();
+			upper = Eigen::Vector3i::Constant(-1);
+			return;
+		}
+		lower = lowerBrick * BrickSize;
+		upper = upperBrick * BrickSize + Eigen::Vector3i::Constant(BrickSize - 1);
+	}
+
+	//returns an estimate of the number of bytes used by the grid
+	size_t MemoryUsage() const;
+
+	//calls f(const Eigen::Vector3i& idx) for every occupied cell
+	//the cells of one brick are visited consecutively
+	template <typename Func>
+	void ForEachOccupiedCell(Func&& f) const
+	{
+		for (auto& brick : bricks)
+		{
+			Eigen::Vector3i origin = brick.first * BrickSize;
+			for (int z = 0; z < BrickSize; ++z)
+			{
+				std::uint64_t word = brick.second[z];
+				while (word != 0)
+				{
+					int bit = LowestBit(word);
+					word &= word - 1;
+					f(Eigen::Vector3i(origin[0] + (bit & 7), origin[1] + (bit >> 3), origin[2] + z));
+				}
+			}
+		}
+	}
+
+	//calls f(const GridTraverser::Cell& cell) for the occupied cells along the ray segment [tMin, tMax] of the ray with
+	//origin o and direction d in the order of increasing ray parameter, the traversal stops early if f returns false
+	//like in GridTraverser, t is measured along the normalized direction
+	//the ray is first traversed on the brick level and only bricks that are allocated are traversed cell by cell
+	//cells that the ray only touches at an edge or corner (tEnter >= tExit) are skipped, which of them the
+	//traversal visits depends on rounding
+	template <typename Func>
+	void TraverseOccupiedCells(const Eigen::Vector3f& o, const Eigen::Vector3f& d, float tMin, float tMax, Func&& f) const
+	{
+		if (bricks.empty())
+			return;
+		//the traversal on the brick level stops when the ray leaves the range of allocated bricks
+		GridTraverser brickTrav(o, d, cellExtents * BrickSize, tMin, tMax);
+		brickTrav.SetCellBounds(lowerBrick, upperBrick);
+		for (auto brick : brickTrav)
+		{
+			auto it = bricks.find(brick.idx);
+			if (it == bricks.end())
+				continue;
+			//the cells are clipped against the cell range of the brick instead of the brick parameters, such that
+			//the cell boundaries are computed exactly like in a traversal of the whole grid
+			GridTraverser cellTrav(o, d, cellExtents, tMin, tMax);
+			cellTrav.SetCellBounds(brick.idx * BrickSize, brick.idx * BrickSize + Eigen::Vector3i::Constant(BrickSize - 1));
+			for (auto cell : cellTrav)
+			{
+				if (!(cell.tEnter < cell.tExit))
+					continue;
+				Eigen::Vector3i local = cell.idx - brick.idx * BrickSize;
+				if ((it->second[local[2]] & CellBit(local)) && !f(cell))
+					return;
+			}
+		}
+	}
+};
+
+//helper function to construct a brick occupancy grid from the triangle faces of the halfedge mesh m
+void BuildBrickGridFromTriangles(const HEMesh& m, BrickOccupancyGrid& grid, const Eigen::Vector3f& cellSize);
+
+//prints the memory usage of the brick grid and the hash grid per occupied cell to the console
+//and reports the occupied cells of the brick grid that are empty in the hash grid
+void ReportGridMemoryUsage(const BrickOccupancyGrid& brickGrid, const HashGrid<Triangle>& hashGrid);
+
+//collects the occupied cells along the camera ray through every pixel of an image with the given size from the near to
+//the far plane, once with TraverseOccupiedCells() and once with a plain GridTraverser over the allocated cell range
+//and Occupied()
+//prints the time of both methods to the console, returns false if they report different cells for a ray
+bool BenchmarkOccupiedCellTraversal(const BrickOccupancyGrid& grid, const Eigen::Matrix4f& view, const Eigen::Matrix4f& proj, int width, int height);
@@ -4,11 +4,37 @@
 
 #pragma once
 
-#include <array>
+#include <algorithm>
+#include <limits>
 #include <Eigen/Core>
 
+//3D-DDA that visits all grid cells pierced by a ray in the order of increasing ray parameter
+//the ray parameter t is measured along the normalized ray direction
+//cells are stepped by integer increments, the ray parameters of the cell boundaries are recomputed
+//from the cell index in each step, such that no error accumulates along long rays
 class GridTraverser
 {
+public:
+	//a cell visited by the traverser together with the ray parameters at which the ray enters and leaves it
+	struct Cell
+	{
+		Eigen::Vector3i idx;
+		float tEnter, tExit;
+	};
+
+	//iterator for range-based for loops over the visited cells
+	class Iterator
+	{
+		GridTraverser* trav;
+	public:
+		Iterator(GridTraverser* t) : trav(t) { }
+		Cell operator*() const { return trav->CurrentCell(); }
+		Iterator& operator++() { (*trav)++; return *this; }
+		//iterators only compare against the end iterator, which is reached when the traversal becomes invalid
+		bool operator!=(const Iterator&) const { return trav->Valid(); }
+	};
+
+private:
 	//ray origin and direction
 	Eigen::Vector3f orig,dir;
 	//grid cell extents
@@ -16,10 +42,21 @@ class GridTraverser
 	//current cell index
 	Eigen::Vector3i current;
 
-	/* you can additional attributes for incremental calculation here */
-	float tMaxX, tMaxY, tMaxZ;
-	float tDeltaX, tDeltaY, tDeltaZ;
-	float stepX, stepY, stepZ;
+	//ray segment [tMin, tMax] that is traversed
+	float tMin, tMax;
+	//optional inclusive range of cell indices outside of which the traversal stops
+	bool bounded;
+	Eigen::Vector3i lowerCell, upperCell;
+
+	//incremental state
+	Eigen::Vector3i step;
+	//1 if the next boundary on an axis is the upper cell boundary, 0 otherwise
+	Eigen::Vector3i boundaryOffset;
+	Eigen::Vector3f invDir;
+	//ray parameters of the next cell boundaries on each axis
+	Eigen::Vector3f tNext;
+	float tEnter, tExit, tEnd;
+	bool valid;
 
 public:
 	//default constructor
@@ -28,6 +65,9 @@ public:
 	//constructs a grid traverser for a given ray with origin o, and ray direction d for a grid with cell extents ce
 	GridTraverser(const Eigen::Vector3f& o, const Eigen::Vector3f&d, const Eigen::Vector3f ce);
 
+	//constructs a grid traverser that visits the cells along the ray segment [tMin, tMax]
+	GridTraverser(const Eigen::Vector3f& o, const Eigen::Vector3f&d, const Eigen::Vector3f ce, float tMin, float tMax);
+
 	//accessor of ray origin
 	Eigen::Vector3f& Origin();
 
@@ -36,12 +76,22 @@ public:
 
 	//accessor of ray direction
 	Eigen::Vector3f& Direction();
-	
+
 	//const accessor of ray direction
-	const Eigen::Vector3f& Direction() const;	
+	const Eigen::Vector3f& Direction() const;
 
 	//set cell extents
-	void SetCellExtents(const Eigen::Vector3f& cellExtent);	
+	void SetCellExtents(const Eigen::Vector3f& cellExtent);
+
+	//restricts the traversal to the ray segment [tMin, tMax]
+	void SetRange(float tMin, float tMax);
+
+	//restricts the traversal to the cells with indices in the inclusive range [lower, upper]
+	//the part of the ray in front of these cells is skipped
+	void SetCellBounds(const Eigen::Vector3i& lower, const Eigen::Vector3i& upper);
+
+	//removes the cell bounds
+	void ClearCellBounds();
 
 	//init at origin cell
 	void Init();
@@ -50,5 +100,21 @@ public:
 	void operator++(int);
 
 	//return current cell index
-	Eigen::Vector3i operator*();		
+	Eigen::Vector3i operator*() const;
+
+	//returns the current cell together with its entry and exit ray parameters
+	Cell CurrentCell() const;
+
+	//ray parameter at which the ray enters the current cell (clamped to the ray segment)
+	float EnterParameter() const;
+
+	//ray parameter at which the ray leaves the current cell (clamped to the ray segment)
+	float ExitParameter() const;
+
+	//returns false if the traversal left the ray segment or the cell bounds
+	bool Valid() const;
+
+	//range-based for loop support, the traversal continues from the current cell
+	Iterator begin();
+	Iterator end();
 };
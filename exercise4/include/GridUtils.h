@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <cmath>
 #include <Eigen/Core>
 
 //converts 3d floating point position pos into 3d integer grid cell index
@@ -13,13 +14,24 @@ inline Eigen::Vector3i PositionToCellIndex(const Eigen::Vector3f& pos, const Eig
 	Eigen::Vector3i idx;
 	for(int d = 0; d < 3; ++d)
 	{
-		idx[d] = int(pos[d]/cellExtents[d]);
-			if (pos[d] < 0)
-				--idx[d];
+		//cells are half-open, a position at an exact multiple of the extent (also a negative one) lies in the cell that starts there
+		idx[d] = (int)std::floor(pos[d]/cellExtents[d]);
 	}
 	return idx;	
 }
 
+//hash function for 3d integer grid cell indices
+struct CellIndexHash
+{
+	size_t operator()(const Eigen::Vector3i &idx ) const
+	{
+		static const int p1 = 131071;
+		static const int p2 = 524287;
+		static const int p3 = 8191;
+		return idx[0] * p1 + idx[1] * p2 + idx[2] * p3;
+	}
+};
+
 //returns true if the two Interval [lb1,ub2] and [lb2,ub2] overlap 
 inline bool OverlapIntervals(float lb1, float ub1, float lb2, float ub2)
 {
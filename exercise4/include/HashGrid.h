@@ -19,16 +19,7 @@ class HashGrid
 public:	
 
 	//hash function
-	struct GridHashFunc
-	{
-		size_t operator()(const Eigen::Vector3i &idx ) const
-		{
-			static const int p1 = 131071;
-			static const int p2 = 524287;
-			static const int p3 = 8191;
-			return idx[0] * p1 + idx[1] * p2 + idx[2] * p3;
-		}
-	};
+	typedef CellIndexHash GridHashFunc;
 	//type of internal hash map
 	typedef std::unordered_map<Eigen::Vector3i,std::vector<Primitive>,GridHashFunc> CellHashMapType;	
 	
@@ -241,14 +232,35 @@ public:
 	typename std::vector<Primitive>::const_iterator PrimitivesBegin(const Eigen::Vector3i& idx) const
 	{
 		assert(!Empty(idx));
-		return cellHashMap[idx].cbegin();
+		return cellHashMap.find(idx)->second.cbegin();
 	}
 
 	//const iterator pointing after the last primitive stored in the cell idx
 	typename std::vector<Primitive>::const_iterator PrimitivesEnd(const Eigen::Vector3i& idx) const
 	{
 		assert(!Empty(idx));
-		return cellHashMap[idx].cend();
+		return cellHashMap.find(idx)->second.cend();
+	}
+
+	//returns a pointer to the primitives stored in the cell idx or nullptr if the cell is empty
+	//this needs a single hash map lookup and can be called concurrently from multiple threads
+	const std::vector<Primitive>* CellPrimitives(const Eigen::Vector3i& idx) const
+	{
+		auto it = cellHashMap.find(idx);
+		if(it == cellHashMap.end())
+			return nullptr;
+		return &it->second;
+	}
+
+	//returns an estimate of the number of bytes used by the hash map including the stored primitives
+	size_t MemoryUsage() const
+	{
+		//each map node stores the key, the primitive vector, the cached hash and the pointer to the next node
+		size_t bytes = sizeof(*this) + cellHashMap.bucket_count() * sizeof(void*);
+		bytes += cellHashMap.size() * (sizeof(typename CellHashMapType::value_type) + sizeof(size_t) + sizeof(void*));
+		for(auto& cell : cellHashMap)
+			bytes += cell.second.capacity() * sizeof(Primitive);
+		return bytes;
 	}
 };
 
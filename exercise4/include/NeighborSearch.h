@@ -0,0 +1,50 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <vector>
+#include <util/OpenMeshUtils.h>
+#include "AABBTree.h"
+#include "HashGrid.h"
+#include "Point.h"
+
+//neighbor lists of all vertices of a mesh in compressed sparse row format
+//the neighbors of vertex i are stored in indices[offsets[i]] ... indices[offsets[i + 1] - 1] in ascending order
+struct NeighborList
+{
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> indices;
+
+	//returns the number of vertices
+	size_t NumVertices() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+	//returns the number of neighbors of vertex i
+	unsigned int NumNeighbors(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+	//returns a pointer to the first neighbor of vertex i
+	const unsigned int* NeighborsBegin(size_t i) const { return indices.data() + offsets[i]; }
+
+	//returns a pointer behind the last neighbor of vertex i
+	const unsigned int* NeighborsEnd(size_t i) const { return indices.data() + offsets[i + 1]; }
+};
+
+//finds all other vertices within distance radius for every vertex of m
+//the vertices are inserted into a hash grid with cell extent radius, such that all neighbors of a vertex
+//lie in the 27 cells around the cell of the vertex
+void FindFixedRadiusNeighbors(const HEMesh& m, float radius, NeighborList& neighbors);
+
+//finds all other vertices within distance radius for every vertex of m using the 27 cells around each vertex
+//the cell extents of the grid must not be smaller than the radius, the vertices are processed in parallel
+void FindFixedRadiusNeighbors(const HEMesh& m, const HashGrid<Point>& grid, float radius, NeighborList& neighbors);
+
+//finds all other vertices within distance radius for every vertex of m using one range query per vertex in the tree
+void FindFixedRadiusNeighbors(const HEMesh& m, const AABBTree<Point>& tree, float radius, NeighborList& neighbors);
+
+//compares the run times of the grid and the tree based neighbor search and prints them to the console
+void BenchmarkFixedRadiusNeighbors(const HEMesh& m, const AABBTree<Point>& tree, float radius);
+
+//builds triangle trees from a randomly shuffled copy of m and from copies reordered along the Morton and the Hilbert
+//curve and prints the build times and the times of closest point queries for all vertices in index order
+void BenchmarkSpatialOrder(const HEMesh& m);
@@ -44,6 +44,9 @@ public:
 
 	//returns a the position of the point as a reference point which is used to sort the primitive in the AABB tree construction
 	Eigen::Vector3f ReferencePoint() const;
+
+	//returns the vertex handle of the point (invalid if the point was not constructed from a mesh vertex)
+	const OpenMesh::VertexHandle& Handle() const;
 };
 
 
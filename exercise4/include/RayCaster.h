@@ -0,0 +1,43 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include "AABBTree.h"
+#include "Triangle.h"
+
+//images produced by the ray caster, the pixels are stored row by row starting with the top row
+struct RayCastImages
+{
+	int width = 0, height = 0;
+	//window space depth in [0, 1] like in the OpenGL depth buffer, 1 for background pixels
+	std::vector<float> depth;
+	//normalized geometric normals of the hit faces, zero for background pixels
+	std::vector<Eigen::Vector3f> normals;
+	//indices of the hit faces, -1 for background pixels
+	std::vector<int> faceIds;
+
+	//writes the depth image to <prefix>_depth.pfm, the normal image to <prefix>_normals.ppm and
+	//the face ids to <prefix>_faces.ppm, which has 16 bit channels and stores the 32 bits of id + 1 in red (high
+	//half) and green (low half), so all face indices are preserved
+	//returns false if one of the files could not be written
+	bool Save(const std::string& prefix) const;
+};
+
+//computes the ray through the center of pixel (x, y) of an image with the given size, y = 0 is the top row
+//the ray starts on the near plane (t = 0) and ends on the far plane (t = 1)
+void PixelRay(const Eigen::Matrix4f& invViewProj, int x, int y, int width, int height, Eigen::Vector3f& o, Eigen::Vector3f& d);
+
+//casts one ray through the center of every pixel of an image with the given size
+//the rays are generated from the view and projection matrix and clipped at the near and far plane
+//the image is split into tiles which are rendered in parallel
+void RayCast(const AABBTree<Triangle>& tree, const Eigen::Matrix4f& view, const Eigen::Matrix4f& proj, int width, int height, RayCastImages& images);
+
+//renders the image with an increasing number of threads up to the hardware concurrency and
+//prints the throughput in million rays per second and the speedup to the console
+//returns false if the images differ between the numbers of threads
+bool BenchmarkRayCaster(const AABBTree<Triangle>& tree, const Eigen::Matrix4f& view, const Eigen::Matrix4f& proj, int width, int height);
@@ -43,6 +43,15 @@ public:
 	float Distance(const Eigen::Vector3f& p) const;
 	//returns a reference point  which is on the triangle and is used to sort the primitive in the AABB tree construction
 	Eigen::Vector3f ReferencePoint() const;
+	//returns true if the ray o + t * d intersects the triangle for a ray parameter t in [tMin, tMax]
+	//in this case, the ray parameter and the barycentric coordinates u and v of v1 and v2 are returned
+	bool Intersect(const Eigen::Vector3f& o, const Eigen::Vector3f& d, float tMin, float tMax, float& t, float& u, float& v) const;
+	//returns true if the triangles have a corner at the same position, i.e. if they share a vertex or an edge of the mesh
+	bool SharesVertex(const Triangle& other) const;
+	//returns the unnormalized geometric normal of the triangle (counter-clockwise orientation)
+	Eigen::Vector3f Normal() const;
+	//returns the face handle of the originating face
+	const OpenMesh::FaceHandle& Handle() const;
 
 };
 
@@ -10,6 +10,7 @@
 
 #include "AABBTree.h"
 #include "HashGrid.h"
+#include "BrickGrid.h"
 #include "Point.h"
 #include "LineSegment.h"
 #include "Triangle.h"
@@ -76,6 +77,7 @@ private:
 	HashGrid<Point> vertexGrid;
 	HashGrid<LineSegment> edgeGrid;
 	HashGrid<Triangle> triangleGrid;
+	BrickOccupancyGrid triangleBricks;
 
 	nse::gui::GLBuffer closestPositions;
 	nse::gui::GLVertexArray closestVAO;
@@ -0,0 +1,73 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+#include <util/OpenMeshUtils.h>
+#include "AABBTree.h"
+#include "Triangle.h"
+
+/*
+regular grid of cubic voxels which stores one inside/outside bit per voxel
+the bits of a voxel column (x, y) along the z-axis are stored in consecutive 64 bit words, such that
+different columns never share a word and can be written concurrently
+*/
+class SolidVoxelGrid
+{
+	Eigen::Vector3i resolution;
+	//position of the lower corner of voxel (0, 0, 0)
+	Eigen::Vector3f origin;
+	//edge length of a voxel
+	float voxelSize;
+	size_t wordsPerColumn;
+	std::vector<std::uint64_t> bits;
+
+public:
+	//constructs an empty grid
+	SolidVoxelGrid();
+
+	//resizes the grid and marks all voxels as outside
+	void Resize(const Eigen::Vector3i& resolution, const Eigen::Vector3f& origin, float voxelSize);
+
+	//returns the number of voxels along each axis
+	const Eigen::Vector3i& Resolution() const { return resolution; }
+
+	//returns the position of the lower corner of voxel (0, 0, 0)
+	const Eigen::Vector3f& Origin() const { return origin; }
+
+	//returns the edge length of a voxel
+	float VoxelSize() const { return voxelSize; }
+
+	//returns the volume of a single voxel
+	double VoxelVolume() const { return (double)voxelSize * voxelSize * voxelSize; }
+
+	//returns the center position of voxel (x, y, z)
+	Eigen::Vector3f VoxelCenter(int x, int y, int z) const;
+
+	//returns true if voxel (x, y, z) is inside
+	bool Inside(int x, int y, int z) const;
+
+	//marks the voxels (x, y, z) with z in [zBegin, zEnd) as inside
+	void SetColumnInside(int x, int y, int zBegin, int zEnd);
+
+	//returns the number of voxels that are inside
+	size_t NumInsideVoxels() const;
+
+	//returns the number of bytes used by the voxel bits
+	size_t MemoryUsage() const { return bits.size() * sizeof(std::uint64_t); }
+};
+
+//voxelizes the solid enclosed by the closed triangle mesh stored in tree
+//the voxel size is chosen such that the mesh bounds (padded by one voxel on each side) span resolution voxels along the largest axis
+//for each voxel column, a ray along the z-axis is intersected with all triangles and the voxels between consecutive
+//pairs of intersections are marked as inside, the columns are processed in parallel
+//returns the number of columns whose ray crossed the surface an odd number of times or only touched it for all jittered
+//ray positions
+size_t VoxelizeSolid(const AABBTree<Triangle>& tree, int resolution, SolidVoxelGrid& grid);
+
+//voxelizes the mesh, reports throughput and memory use and compares the voxel volume with the volume enclosed by the mesh
+void BenchmarkVoxelization(const HEMesh& m, const AABBTree<Triangle>& tree, int resolution);
@@ -171,4 +171,21 @@ float Box::Distance(const Eigen::Vector3f& p) const
 	return sqrt(SqrDistance(p));
 }
 
-
+//returns true if the ray o + t * d intersects the box for a ray parameter t in [tMin, tMax]
+bool Box::IntersectRay(const Eigen::Vector3f& o, const Eigen::Vector3f& invDir, float tMin, float tMax, float& tEnter) const
+{
+	//slab test, NaNs from 0 * infinity are discarded by the order of the min/max arguments
+	for (int d = 0; d < 3; ++d)
+	{
+		float t0 = (LowerBound()[d] - o[d]) * invDir[d];
+		float t1 = (UpperBound()[d] - o[d]) * invDir[d];
+		if (invDir[d] < 0)
+			std::swap(t0, t1);
+		tMin = t0 > tMin ? t0 : tMin;
+		tMax = t1 < tMax ? t1 : tMax;
+		if (tMin > tMax)
+			return false;
+	}
+	tEnter = tMin;
+	return true;
+}
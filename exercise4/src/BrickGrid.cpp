@@ -0,0 +1,168 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "BrickGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <Eigen/LU>
+#include <util/Benchmark.h>
+#include "RayCaster.h"
+
+BrickOccupancyGrid::BrickOccupancyGrid(const Eigen::Vector3f& cellExtents)
+	: cellExtents(cellExtents), occupiedCells(0), lowerBrick(Eigen::Vector3i::Zero()), upperBrick(Eigen::Vector3i::Zero())
+{
+}
+
+Box BrickOccupancyGrid::CellBounds(const Eigen::Vector3i& idx) const
+{
+	//same corner positions as in the hash grid
+	Eigen::Vector3f lb, ub;
+	for (int d = 0; d < 3; ++d)
+	{
+		lb[d] = idx[d] * cellExtents[d];
+		ub[d] = (idx[d] + 1) * cellExtents[d];
+	}
+	return Box(lb, ub);
+}
+
+Box BrickOccupancyGrid::BrickBounds(const Eigen::Vector3i& brickIdx) const
+{
+	//union of the cell bounds, such that every cell box of the brick is contained in the brick box
+	Box b = CellBounds(brickIdx * BrickSize);
+	b.Insert(CellBounds(brickIdx * BrickSize + Eigen::Vector3i::Constant(BrickSize - 1)));
+	return b;
+}
+
+void BrickOccupancyGrid::SetOccupied(const Eigen::Vector3i& idx)
+{
+	Eigen::Vector3i brickIdx = BrickIndex(idx);
+	auto it = bricks.find(brickIdx);
+	if (it == bricks.end())
+	{
+		if (bricks.empty())
+			lowerBrick = upperBrick = brickIdx;
+		lowerBrick = lowerBrick.cwiseMin(brickIdx);
+		upperBrick = upperBrick.cwiseMax(brickIdx);
+		Brick empty;
+		empty.fill(0);
+		it = bricks.insert(std::make_pair(brickIdx, empty)).first;
+	}
+	std::uint64_t& word = it->second[idx[2] & 7];
+	std::uint64_t bit = CellBit(idx);
+	if ((word & bit) == 0)
+	{
+		word |= bit;
+		++occupiedCells;
+	}
+}
+
+bool BrickOccupancyGrid::Occupied(const Eigen::Vector3i& idx) const
+{
+	auto it = bricks.find(BrickIndex(idx));
+	if (it == bricks.end())
+		return false;
+	return (it->second[idx[2] & 7] & CellBit(idx)) != 0;
+}
+
+void BrickOccupancyGrid::Clear()
+{
+	bricks.clear();
+	occupiedCells = 0;
+}
+
+size_t BrickOccupancyGrid::MemoryUsage() const
+{
+	//each map node stores the key, the brick, the cached hash and the pointer to the next node
+	return sizeof(*this) + bricks.bucket_count() * sizeof(void*)
+		+ bricks.size() * (sizeof(BrickHashMapType::value_type) + sizeof(size_t) + sizeof(void*));
+}
+
+void BuildBrickGridFromTriangles(const HEMesh& m, BrickOccupancyGrid& grid, const Eigen::Vector3f& cellSize)
+{
+	std::cout << "Building brick occupancy grid from triangles .." << std::endl;
+	grid = BrickOccupancyGrid(cellSize);
+	auto fend = m.faces_end();
+	for(auto fit = m.faces_begin(); fit != fend; ++fit)
+		grid.Insert(Triangle(m,*fit));
+	std::cout << "Done (using " << grid.NumBricks() << " bricks for " << grid.NumOccupiedCells() << " cells)." << std::endl;
+}
+
+void ReportGridMemoryUsage(const BrickOccupancyGrid& brickGrid, const HashGrid<Triangle>& hashGrid)
+{
+	size_t brickBytes = brickGrid.MemoryUsage();
+	size_t hashBytes = hashGrid.MemoryUsage();
+	size_t brickCells = std::max<size_t>(1, brickGrid.NumOccupiedCells());
+	size_t hashCells = std::max<size_t>(1, hashGrid.NumCells());
+	std::cout << "Brick occupancy grid: " << brickBytes << " bytes, " << (double)brickBytes / brickCells << " bytes per occupied cell." << std::endl;
+	std::cout << "Triangle hash grid: " << hashBytes << " bytes, " << (double)hashBytes / hashCells << " bytes per occupied cell." << std::endl;
+	if (brickGrid.NumOccupiedCells() != hashGrid.NumCells())
+		std::cout << "The grids contain a different number of occupied cells (" << brickGrid.NumOccupiedCells() << " vs. " << hashGrid.NumCells() << ")." << std::endl;
+
+	//both grids use the same cell overlap test, so every occupied brick grid cell must be a non-empty hash grid cell
+	size_t missingCells = 0;
+	brickGrid.ForEachOccupiedCell([&](const Eigen::Vector3i& idx)
+	{
+		if (hashGrid.Empty(idx))
+			++missingCells;
+	});
+	if (missingCells != 0)
+		std::cout << missingCells << " occupied cells of the brick grid are empty in the triangle hash grid." << std::endl;
+}
+
+bool BenchmarkOccupiedCellTraversal(const BrickOccupancyGrid& grid, const Eigen::Matrix4f& view, const Eigen::Matrix4f& proj, int width, int height)
+{
+	Eigen::Matrix4f invViewProj = (proj * view).inverse();
+	//the rays end on the far plane, the traversers measure t along the normalized direction
+	std::vector<Eigen::Vector3f> origins, directions;
+	origins.reserve((size_t)width * height);
+	directions.reserve((size_t)width * height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+		{
+			Eigen::Vector3f o, d;
+			PixelRay(invViewProj, x, y, width, height, o, d);
+			origins.push_back(o);
+			directions.push_back(d);
+		}
+	std::cout << "Traversing the occupied cells along " << origins.size() << " rays .." << std::endl;
+
+	//the occupied cells of all rays one after another, rayEnd[i] is the end of the cells of ray i
+	std::vector<Eigen::Vector3i> cells, referenceCells;
+	std::vector<size_t> rayEnd(origins.size()), referenceRayEnd(origins.size());
+
+	//the plain traversal visits every cell of the allocated range along the ray
+	Eigen::Vector3i lowerCell, upperCell;
+	grid.AllocatedCellRange(lowerCell, upperCell);
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < origins.size(); ++i)
+	{
+		GridTraverser trav(origins[i], directions[i], grid.CellExtents(), 0, directions[i].norm());
+		trav.SetCellBounds(lowerCell, upperCell);
+		//cells that are only touched at an edge or corner are skipped like in TraverseOccupiedCells()
+		for (auto cell : trav)
+			if (cell.tEnter < cell.tExit && grid.Occupied(cell.idx))
+				referenceCells.push_back(cell.idx);
+		referenceRayEnd[i] = referenceCells.size();
+	}
+	double referenceTime = nse::util::MillisecondsSince(timeStart);
+
+	timeStart = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < origins.size(); ++i)
+	{
+		grid.TraverseOccupiedCells(origins[i], directions[i], 0, directions[i].norm(), [&](const GridTraverser::Cell& cell)
+		{
+			cells.push_back(cell.idx);
+			return true;
+		});
+		rayEnd[i] = cells.size();
+	}
+	double brickTime = nse::util::MillisecondsSince(timeStart);
+
+	std::cout << "GridTraverser and Occupied(): " << referenceTime << " ms, TraverseOccupiedCells(): " << brickTime
+		<< " ms, speedup " << referenceTime / brickTime << " (" << cells.size() << " occupied cells)." << std::endl;
+	return nse::util::CheckResult(rayEnd == referenceRayEnd && cells == referenceCells, "occupied cell traversal");
+}
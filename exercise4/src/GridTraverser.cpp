@@ -2,17 +2,24 @@
 // chair of the TU Dresden. Do not distribute! 
 // Copyright (C) CGV TU Dresden - All Rights Reserved
 
-#include <iostream>
 #include "GridTraverser.h"
 #include "GridUtils.h"
 #include <limits>
 
 
 GridTraverser::GridTraverser()
+	: tMin(0), tMax(std::numeric_limits<float>::infinity()), bounded(false), valid(false)
 { }
 
 GridTraverser::GridTraverser(const Eigen::Vector3f& o, const Eigen::Vector3f&d, const Eigen::Vector3f cell_extents)
-	: orig(o), dir(d), cellExtents(cell_extents)
+	: orig(o), dir(d), cellExtents(cell_extents), tMin(0), tMax(std::numeric_limits<float>::infinity()), bounded(false)
+{
+	dir.normalize();
+	Init();
+}
+
+GridTraverser::GridTraverser(const Eigen::Vector3f& o, const Eigen::Vector3f&d, const Eigen::Vector3f cell_extents, float tMin, float tMax)
+	: orig(o), dir(d), cellExtents(cell_extents), tMin(tMin), tMax(tMax), bounded(false)
 {
 	dir.normalize();
 	Init();
@@ -43,73 +50,156 @@ void GridTraverser::SetCellExtents(const Eigen::Vector3f& cellExtent)
 	Init();
 }
 
-void GridTraverser::Init()
+void GridTraverser::SetRange(float tMin, float tMax)
 {
-	current = PositionToCellIndex(orig, cellExtents);
-	/* Task 3.2.2 */
-	//you can add some precalculation code here
-	// https://tu-dresden.de/ing/informatik/smt/cgv/ressourcen/dateien/lehre/ws-18-19/cg1/CGI_11_Grids-and-Hierarchies.pdf?lang=de
-	// https://stackoverflow.com/questions/49188302/how-can-you-iterate-linearly-through-a-3d-grid
-	// https://www.scratchapixel.com/lessons/advanced-rendering/introduction-acceleration-structure/grid
-	// http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.42.3443&rep=rep1&type=pdf
-	// https://github.com/francisengelmann/fast_voxel_traversal/blob/master/main.cpp
-	//dir.normalize();
-	/*
-	std::cout << "Origin of grid traversal: " << orig << "\n";
-	std::cout << "Direction of grid traversal: " << dir << "\n";
-	std::cout << "Extents of grid traversal: " << cellExtents << "\n";
-    std::cout << "Current: " << current << "\n";
-    */
-
-	stepX = dir(0) < 0 ? -cellExtents(0) : cellExtents(0);
-	stepY = dir(1) < 0 ? -cellExtents(1) : cellExtents(1);
-	stepZ = dir(2) < 0 ? -cellExtents(2) : cellExtents(2);
-
-	float nextVoxelBoundaryX = (current(0) + stepX) * cellExtents(0);
-	float nextVoxelBoundaryY = (current(1) + stepY) * cellExtents(1);
-	float nextVoxelBoundaryZ = (current(2) + stepZ) * cellExtents(2);
-
-	if (stepX < 0) nextVoxelBoundaryX += cellExtents(0);
-    if (stepY < 0) nextVoxelBoundaryY += cellExtents(1);
-    if (stepZ < 0) nextVoxelBoundaryZ += cellExtents(2);
-
-	tMaxX = dir(0) != 0.0 ? (nextVoxelBoundaryX - orig(0)) / dir(0) : std::numeric_limits<float>::max();
-	tMaxY = dir(1) != 0.0 ? (nextVoxelBoundaryY - orig(1)) / dir(1) : std::numeric_limits<float>::max();
-	tMaxZ = dir(2) != 0.0 ? (nextVoxelBoundaryZ - orig(2)) / dir(2) : std::numeric_limits<float>::max();
-
-	tDeltaX = dir(0) != 0.0 ? cellExtents(0) / dir(0) * stepX : std::numeric_limits<float>::max();
-	tDeltaY = dir(1) != 0.0 ? cellExtents(1) / dir(1) * stepY : std::numeric_limits<float>::max();
-	tDeltaZ = dir(2) != 0.0 ? cellExtents(2) / dir(2) * stepZ : std::numeric_limits<float>::max();
+	this->tMin = tMin;
+	this->tMax = tMax;
+	Init();
 }
 
-void GridTraverser::operator++(int)
+void GridTraverser::SetCellBounds(const Eigen::Vector3i& lower, const Eigen::Vector3i& upper)
+{
+	bounded = true;
+	lowerCell = lower;
+	upperCell = upper;
+	Init();
+}
+
+void GridTraverser::ClearCellBounds()
 {
-	/* Task 3.2.2 */
-	//traverse one step along the ray
-	//update the cell index stored in attribute "current"
-	if (tMaxX < tMaxY) {
-		if (tMaxX < tMaxZ) {
-			orig(0) += stepX;
-			tMaxX += tDeltaX;
-		} else {
-			orig(2) += stepZ;
-			tMaxZ += tDeltaZ;
+	bounded = false;
+	Init();
+}
+
+void GridTraverser::Init()
+{
+	float tStart = tMin;
+	tEnd = tMax;
+
+	for (int d = 0; d < 3; ++d)
+		invDir(d) = dir(d) != 0 ? 1.0f / dir(d) : std::numeric_limits<float>::infinity();
+
+	//clip the ray segment against the bounding box of the cell bounds
+	if (bounded)
+	{
+		for (int d = 0; d < 3; ++d)
+		{
+			float lb = lowerCell(d) * cellExtents(d);
+			float ub = (upperCell(d) + 1) * cellExtents(d);
+			if (dir(d) == 0)
+			{
+				if (orig(d) < lb || orig(d) > ub)
+					tEnd = -std::numeric_limits<float>::infinity();
+				continue;
+			}
+			float t0 = (lb - orig(d)) * invDir(d);
+			float t1 = (ub - orig(d)) * invDir(d);
+			if (t0 > t1)
+				std::swap(t0, t1);
+			tStart = std::max(tStart, t0);
+			tEnd = std::min(tEnd, t1);
 		}
-	} else {
-		if (tMaxY < tMaxZ) {
-			orig(1) += stepY;
-			tMaxY += tDeltaY;
-		} else {
-			orig(2) += stepZ;
-			tMaxZ += tDeltaZ;
+	}
+	valid = tStart <= tEnd;
+
+	current = PositionToCellIndex(orig + tStart * dir, cellExtents);
+
+	for (int d = 0; d < 3; ++d)
+	{
+		if (dir(d) > 0)
+		{
+			step(d) = 1;
+			boundaryOffset(d) = 1;
+		}
+		else if (dir(d) < 0)
+		{
+			step(d) = -1;
+			boundaryOffset(d) = 0;
 		}
+		else
+		{
+			step(d) = 0;
+			boundaryOffset(d) = 0;
+			continue;
+		}
+		//the entry point can be rounded into a neighbor cell if it lies close to a cell boundary, so the cell is
+		//corrected with the boundary parameters that the steps use
+		float tLeave = ((current(d) + boundaryOffset(d)) * cellExtents(d) - orig(d)) * invDir(d);
+		float tReach = ((current(d) + 1 - boundaryOffset(d)) * cellExtents(d) - orig(d)) * invDir(d);
+		if (tLeave < tStart)
+			current(d) += step(d);
+		else if (tReach > tStart)
+			current(d) -= step(d);
+	}
+	//the clipped entry point can be rounded into a neighbor cell of the bounds
+	if (bounded)
+		current = current.cwiseMax(lowerCell).cwiseMin(upperCell);
+
+	for (int d = 0; d < 3; ++d)
+		tNext(d) = step(d) != 0 ? ((current(d) + boundaryOffset(d)) * cellExtents(d) - orig(d)) * invDir(d) : std::numeric_limits<float>::infinity();
+
+	tEnter = tStart;
+	tExit = std::min(tNext.minCoeff(), tEnd);
+}
+
+void GridTraverser::operator++(int)
+{
+	if (!valid)
+		return;
+
+	//step over the nearest cell boundary
+	Eigen::Vector3f::Index axis;
+	float t = tNext.minCoeff(&axis);
+	if (!(t < tEnd))
+	{
+		valid = false;
+		return;
 	}
-	current = PositionToCellIndex(orig, cellExtents);
+	current(axis) += step(axis);
+	if (bounded && (current(axis) < lowerCell(axis) || current(axis) > upperCell(axis)))
+		valid = false;
+
+	//the boundary parameter is derived from the integer cell index instead of being accumulated
+	tNext(axis) = ((current(axis) + boundaryOffset(axis)) * cellExtents(axis) - orig(axis)) * invDir(axis);
+	tEnter = t;
+	tExit = std::min(tNext.minCoeff(), tEnd);
 }
 
-Eigen::Vector3i GridTraverser::operator*()
+Eigen::Vector3i GridTraverser::operator*() const
 {
 	return current;
 }
 
-	
+GridTraverser::Cell GridTraverser::CurrentCell() const
+{
+	Cell c;
+	c.idx = current;
+	c.tEnter = tEnter;
+	c.tExit = tExit;
+	return c;
+}
+
+float GridTraverser::EnterParameter() const
+{
+	return tEnter;
+}
+
+float GridTraverser::ExitParameter() const
+{
+	return tExit;
+}
+
+bool GridTraverser::Valid() const
+{
+	return valid;
+}
+
+GridTraverser::Iterator GridTraverser::begin()
+{
+	return Iterator(this);
+}
+
+GridTraverser::Iterator GridTraverser::end()
+{
+	return Iterator(this);
+}
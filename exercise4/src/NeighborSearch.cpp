@@ -0,0 +1,164 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "NeighborSearch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include <util/Parallel.h>
+#include <util/SpatialOrder.h>
+
+//number of vertices whose neighbors are collected into one buffer
+const size_t neighborChunkSize = 4096;
+
+//builds the neighbor lists of n vertices in parallel
+//GatherFunctor: void(unsigned int vertex, unsigned int thread, std::vector<unsigned int>& appendNeighbors)
+template <typename GatherFunctor>
+void AssembleNeighborList(size_t n, NeighborList& neighbors, GatherFunctor&& gather)
+{
+	neighbors.offsets.assign(n + 1, 0);
+	size_t nChunks = (n + neighborChunkSize - 1) / neighborChunkSize;
+	std::vector<std::vector<unsigned int>> chunkIndices(nChunks);
+
+	//collect the neighbors of each chunk into a separate buffer and count them
+	nse::util::ParallelForChunks(0, n, neighborChunkSize, [&](size_t chunk, size_t begin, size_t end, unsigned int thread)
+	{
+		auto& buffer = chunkIndices[chunk];
+		for (size_t i = begin; i < end; ++i)
+		{
+			size_t first = buffer.size();
+			gather((unsigned int)i, thread, buffer);
+			std::sort(buffer.begin() + first, buffer.end());
+			neighbors.offsets[i + 1] = (unsigned int)(buffer.size() - first);
+		}
+	});
+
+	for (size_t i = 0; i < n; ++i)
+		neighbors.offsets[i + 1] += neighbors.offsets[i];
+
+	//copy the buffers to their final place
+	neighbors.indices.resize(neighbors.offsets[n]);
+	nse::util::ParallelForChunks(0, nChunks, 1, [&](size_t chunk, size_t, size_t, unsigned int)
+	{
+		auto& buffer = chunkIndices[chunk];
+		std::copy(buffer.begin(), buffer.end(), neighbors.indices.begin() + neighbors.offsets[chunk * neighborChunkSize]);
+	});
+}
+
+void FindFixedRadiusNeighbors(const HEMesh& m, float radius, NeighborList& neighbors)
+{
+	HashGrid<Point> grid;
+	BuildHashGridFromVertices(m, grid, Eigen::Vector3f::Constant(radius));
+	FindFixedRadiusNeighbors(m, grid, radius, neighbors);
+}
+
+void FindFixedRadiusNeighbors(const HEMesh& m, const HashGrid<Point>& grid, float radius, NeighborList& neighbors)
+{
+	assert(grid.CellExtents().minCoeff() >= radius);
+	const float sqrRadius = radius * radius;
+
+	AssembleNeighborList(m.n_vertices(), neighbors, [&](unsigned int i, unsigned int, std::vector<unsigned int>& result)
+	{
+		Eigen::Vector3f p = ToEigenVector(m.point(m.vertex_handle(i)));
+		Eigen::Vector3i center = grid.PositionToIndex(p);
+		Eigen::Vector3i idx;
+		for (idx[0] = center[0] - 1; idx[0] <= center[0] + 1; ++idx[0])
+			for (idx[1] = center[1] - 1; idx[1] <= center[1] + 1; ++idx[1])
+				for (idx[2] = center[2] - 1; idx[2] <= center[2] + 1; ++idx[2])
+				{
+					auto cell = grid.CellPrimitives(idx);
+					if (cell == nullptr)
+						continue;
+					for (auto& point : *cell)
+						if (point.Handle().idx() != (int)i && point.SqrDistance(p) <= sqrRadius)
+							result.push_back(point.Handle().idx());
+				}
+	});
+}
+
+void FindFixedRadiusNeighbors(const HEMesh& m, const AABBTree<Point>& tree, float radius, NeighborList& neighbors)
+{
+	const float sqrRadius = radius * radius;
+
+	std::vector<std::vector<const Point*>> perThreadResults(nse::util::NumThreads());
+	AssembleNeighborList(m.n_vertices(), neighbors, [&](unsigned int i, unsigned int thread, std::vector<unsigned int>& result)
+	{
+		auto& found = perThreadResults[thread];
+		found.clear();
+		tree.RangeQuery(ToEigenVector(m.point(m.vertex_handle(i))), sqrRadius, found);
+		for (auto point : found)
+			if (point->Handle().idx() != (int)i)
+				result.push_back(point->Handle().idx());
+	});
+}
+
+void BenchmarkFixedRadiusNeighbors(const HEMesh& m, const AABBTree<Point>& tree, float radius)
+{
+	std::cout << "Fixed radius neighbor search for " << m.n_vertices() << " vertices with radius " << radius
+		<< " using " << nse::util::NumThreads() << " threads .." << std::endl;
+
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	HashGrid<Point> grid;
+	BuildHashGridFromVertices(m, grid, Eigen::Vector3f::Constant(radius));
+	auto timeBuilt = std::chrono::high_resolution_clock::now();
+	NeighborList gridNeighbors;
+	FindFixedRadiusNeighbors(m, grid, radius, gridNeighbors);
+	auto timeEnd = std::chrono::high_resolution_clock::now();
+	std::cout << "Hash grid: construction took " << std::chrono::duration_cast<std::chrono::milliseconds>(timeBuilt - timeStart).count()
+		<< " ms, queries took " << std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeBuilt).count() << " ms." << std::endl;
+
+	timeStart = std::chrono::high_resolution_clock::now();
+	NeighborList treeNeighbors;
+	FindFixedRadiusNeighbors(m, tree, radius, treeNeighbors);
+	timeEnd = std::chrono::high_resolution_clock::now();
+	std::cout << "AABB tree: queries took " << std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeStart).count() << " ms." << std::endl;
+
+	size_t n = gridNeighbors.indices.size();
+	std::cout << "Found " << n << " neighbors (" << (m.n_vertices() == 0 ? 0.0 : (double)n / m.n_vertices()) << " per vertex)";
+	if (gridNeighbors.offsets != treeNeighbors.offsets || gridNeighbors.indices != treeNeighbors.indices)
+		std::cout << ", the results of grid and tree differ!";
+	std::cout << std::endl;
+}
+
+void BenchmarkSpatialOrder(const HEMesh& m)
+{
+	std::cout << "AABB tree of " << m.n_faces() << " faces with spatially ordered meshes .." << std::endl;
+	//the copies are rebuilt by PermuteMesh, which keeps the registered properties of m but resets their values, the
+	//tree is built from the points only
+	HEMesh shuffled = m;
+	if (!ShuffleMesh(shuffled, 0))
+	{
+		std::cout << "The shuffled mesh could not be rebuilt." << std::endl;
+		return;
+	}
+
+	const char* names[] = { "Shuffled", "Morton", "Hilbert" };
+	for (int order = 0; order < 3; ++order)
+	{
+		HEMesh ordered = shuffled;
+		if (order > 0 && !ReorderMeshAlongCurve(ordered, order == 1 ? SpaceFillingCurve::Morton : SpaceFillingCurve::Hilbert))
+		{
+			std::cout << "The mesh could not be rebuilt in " << names[order] << " order." << std::endl;
+			continue;
+		}
+
+		AABBTree<Triangle> tree;
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		BuildAABBTreeFromTriangles(ordered, tree);
+		auto timeBuilt = std::chrono::high_resolution_clock::now();
+		float maxDistance = 0;
+		for (auto v : ordered.vertices())
+		{
+			Eigen::Vector3f p = ToEigenVector(ordered.point(v));
+			maxDistance = std::max(maxDistance, (tree.ClosestPoint(p) - p).norm());
+		}
+		auto timeEnd = std::chrono::high_resolution_clock::now();
+		std::cout << names[order] << " order: construction took " << std::chrono::duration<double, std::milli>(timeBuilt - timeStart).count()
+			<< " ms, closest point queries took " << std::chrono::duration<double, std::milli>(timeEnd - timeBuilt).count()
+			<< " ms (largest distance " << maxDistance << ")" << std::endl;
+	}
+}
@@ -63,3 +63,9 @@ Eigen::Vector3f Point::ReferencePoint() const
 {
 	return v0;
 }
+
+//returns the vertex handle of the point (invalid if the point was not constructed from a mesh vertex)
+const OpenMesh::VertexHandle& Point::Handle() const
+{
+	return h;
+}
@@ -0,0 +1,146 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "RayCaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+#include <Eigen/LU>
+#include <util/Parallel.h>
+#include <util/Benchmark.h>
+
+//edge length of the square image tiles that are processed by one task
+const int tileSize = 16;
+
+void PixelRay(const Eigen::Matrix4f& invViewProj, int x, int y, int width, int height, Eigen::Vector3f& o, Eigen::Vector3f& d)
+{
+	float ndcX = 2.0f * (x + 0.5f) / width - 1.0f;
+	float ndcY = 1.0f - 2.0f * (y + 0.5f) / height;
+	o = (invViewProj * Eigen::Vector4f(ndcX, ndcY, -1, 1)).hnormalized();
+	d = (invViewProj * Eigen::Vector4f(ndcX, ndcY, 1, 1)).hnormalized() - o;
+}
+
+void RayCast(const AABBTree<Triangle>& tree, const Eigen::Matrix4f& view, const Eigen::Matrix4f& proj, int width, int height, RayCastImages& images)
+{
+	images.width = width;
+	images.height = height;
+	size_t n = (size_t)width * height;
+	images.depth.assign(n, 1.0f);
+	images.normals.assign(n, Eigen::Vector3f::Zero());
+	images.faceIds.assign(n, -1);
+
+	Eigen::Matrix4f viewProj = proj * view;
+	Eigen::Matrix4f invViewProj = viewProj.inverse();
+
+	int tilesX = (width + tileSize - 1) / tileSize;
+	int tilesY = (height + tileSize - 1) / tileSize;
+	nse::util::ParallelForChunks(0, (size_t)tilesX * tilesY, 1, [&](size_t tile, size_t, size_t, unsigned int)
+	{
+		int x0 = (int)(tile % tilesX) * tileSize;
+		int y0 = (int)(tile / tilesX) * tileSize;
+		int x1 = std::min(x0 + tileSize, width);
+		int y1 = std::min(y0 + tileSize, height);
+		for (int y = y0; y < y1; ++y)
+			for (int x = x0; x < x1; ++x)
+			{
+				Eigen::Vector3f o, d;
+				PixelRay(invViewProj, x, y, width, height, o, d);
+
+				float t, u, v;
+				const Triangle* hit = tree.ClosestIntersection(o, d, 0, 1, t, u, v);
+				if (hit == nullptr)
+					continue;
+
+				size_t i = (size_t)y * width + x;
+				Eigen::Vector4f clip = viewProj * (o + t * d).homogeneous();
+				images.depth[i] = 0.5f * clip.z() / clip.w() + 0.5f;
+				images.normals[i] = hit->Normal().normalized();
+				images.faceIds[i] = hit->Handle().idx();
+			}
+	});
+}
+
+bool BenchmarkRayCaster(const AABBTree<Triangle>& tree, const Eigen::Matrix4f& view, const Eigen::Matrix4f& proj, int width, int height)
+{
+	std::cout << "Ray casting " << width << " x " << height << " pixels .." << std::endl;
+	//every pixel is written by exactly one task, so the images must not depend on the threads
+	RayCastImages images, singleThreadImages;
+	return nse::util::MeasureThreadScaling("Ray casting",
+		[&]() { RayCast(tree, view, proj, width, height, images); },
+		[&](unsigned int threads)
+		{
+			if (threads == 1)
+				singleThreadImages = images;
+			return images.depth == singleThreadImages.depth && images.normals == singleThreadImages.normals
+				&& images.faceIds == singleThreadImages.faceIds;
+		}, 0, (double)width * height, "rays");
+}
+
+//writes a single channel float image in the portable float map format (little endian, bottom row first)
+static bool WritePFM(const std::string& filename, int width, int height, const std::vector<float>& pixels)
+{
+	std::ofstream f(filename, std::ios::binary);
+	if (!f)
+		return false;
+	f << "Pf\n" << width << " " << height << "\n-1.0\n";
+	for (int y = height - 1; y >= 0; --y)
+		f.write((const char*)&pixels[(size_t)y * width], width * sizeof(float));
+	return (bool)f;
+}
+
+//writes an RGB image in the binary portable pixmap format (top row first), with 16 bit channels if maxValue > 255
+template <typename Channel>
+static bool WritePPM(const std::string& filename, int width, int height, const std::vector<Channel>& rgb, unsigned int maxValue)
+{
+	std::ofstream f(filename, std::ios::binary);
+	if (!f)
+		return false;
+	f << "P6\n" << width << " " << height << "\n" << maxValue << "\n";
+	//16 bit samples are stored big endian
+	for (auto value : rgb)
+	{
+		if (maxValue > 255)
+			f.put((char)(value >> 8));
+		f.put((char)value);
+	}
+	return (bool)f;
+}
+
+bool RayCastImages::Save(const std::string& prefix) const
+{
+	size_t n = (size_t)width * height;
+	std::vector<std::uint8_t> normalColors(3 * n);
+	std::vector<std::uint16_t> faceColors(3 * n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+			normalColors[3 * i + c] = (std::uint8_t)std::round(127.5f * (normals[i][c] + 1.0f));
+		std::uint32_t id = (std::uint32_t)(faceIds[i] + 1);
+		faceColors[3 * i + 0] = (std::uint16_t)(id >> 16);
+		faceColors[3 * i + 1] = (std::uint16_t)id;
+		faceColors[3 * i + 2] = 0;
+	}
+
+	bool success = true;
+	if (!WritePFM(prefix + "_depth.pfm", width, height, depth))
+	{
+		std::cerr << "Could not write " << prefix << "_depth.pfm" << std::endl;
+		success = false;
+	}
+	if (!WritePPM(prefix + "_normals.ppm", width, height, normalColors, 255))
+	{
+		std::cerr << "Could not write " << prefix << "_normals.ppm" << std::endl;
+		success = false;
+	}
+	if (!WritePPM(prefix + "_faces.ppm", width, height, faceColors, 65535))
+	{
+		std::cerr << "Could not write " << prefix << "_faces.ppm" << std::endl;
+		success = false;
+	}
+	return success;
+}
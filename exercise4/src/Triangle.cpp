@@ -430,6 +430,49 @@ Eigen::Vector3f Triangle::ReferencePoint() const
 {
 	return (v0+v1+v2)/3.0f;
 }
+//returns true if the ray o + t * d intersects the triangle for a ray parameter t in [tMin, tMax]
+bool Triangle::Intersect(const Eigen::Vector3f& o, const Eigen::Vector3f& d, float tMin, float tMax, float& t, float& u, float& v) const
+{
+	//Moeller-Trumbore intersection test
+	Eigen::Vector3f edge0 = v1 - v0;
+	Eigen::Vector3f edge1 = v2 - v0;
+	Eigen::Vector3f p = d.cross(edge1);
+	float det = edge0.dot(p);
+	if (det == 0.f)
+		return false;
+	float invDet = 1.f / det;
+
+	Eigen::Vector3f s = o - v0;
+	u = s.dot(p) * invDet;
+	if (u < 0.f || u > 1.f)
+		return false;
+
+	Eigen::Vector3f q = s.cross(edge0);
+	v = d.dot(q) * invDet;
+	if (v < 0.f || u + v > 1.f)
+		return false;
+
+	t = edge1.dot(q) * invDet;
+	return t >= tMin && t <= tMax;
+}
+//returns true if the triangles have a corner at the same position
+bool Triangle::SharesVertex(const Triangle& other) const
+{
+	for (auto p : { &v0, &v1, &v2 })
+		if (*p == other.v0 || *p == other.v1 || *p == other.v2)
+			return true;
+	return false;
+}
+//returns the unnormalized geometric normal of the triangle
+Eigen::Vector3f Triangle::Normal() const
+{
+	return (v1 - v0).cross(v2 - v0);
+}
+//returns the face handle of the originating face
+const OpenMesh::FaceHandle& Triangle::Handle() const
+{
+	return h;
+}
 
 
 
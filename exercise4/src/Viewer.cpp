@@ -21,6 +21,9 @@
 
 #include <gui/ShaderPool.h>
 #include "GridTraverser.h"
+#include "NeighborSearch.h"
+#include "RayCaster.h"
+#include "Voxelizer.h"
 
 Viewer::Viewer()
 	: AbstractViewer("CG1 Exercise 3"),
@@ -81,6 +84,57 @@ void Viewer::SetupGUI()
 
 	shadingBtn = new nanogui::ComboBox(mainWindow, { "Smooth Shading", "Flat Shading" });
 
+	auto neighborsBtn = new nanogui::Button(mainWindow, "Benchmark Neighbor Search");
+	neighborsBtn->setCallback([this]() {
+		if (!polymesh.vertices_empty())
+			BenchmarkFixedRadiusNeighbors(polymesh, vertexTree, 0.01f * bboxMaxLength);
+	});
+
+	auto spatialOrderBtn = new nanogui::Button(mainWindow, "Benchmark Spatial Order");
+	spatialOrderBtn->setCallback([this]() {
+		if (!polymesh.vertices_empty())
+			BenchmarkSpatialOrder(polymesh);
+	});
+
+	auto rayCastBtn = new nanogui::Button(mainWindow, "Ray Cast Images");
+	rayCastBtn->setCallback([this]() {
+		if (polymesh.vertices_empty())
+			return;
+		std::vector<std::pair<std::string, std::string>> fileTypes;
+		fileTypes.push_back(std::make_pair("pfm", "Depth Image"));
+		auto file = nanogui::file_dialog(fileTypes, true);
+		if (file.empty())
+			return;
+		auto extension = file.rfind(".pfm");
+		if (extension != std::string::npos)
+			file = file.substr(0, extension);
+
+		Eigen::Matrix4f view, proj;
+		camera().ComputeCameraMatrices(view, proj);
+		BenchmarkRayCaster(triangleTree, view, proj, width(), height());
+		RayCastImages images;
+		RayCast(triangleTree, view, proj, width(), height(), images);
+		if (!images.Save(file))
+			new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Warning, "Ray Cast Images",
+				"The images could not be saved");
+	});
+
+	auto brickTraversalBtn = new nanogui::Button(mainWindow, "Benchmark Brick Traversal");
+	brickTraversalBtn->setCallback([this]() {
+		if (polymesh.vertices_empty())
+			return;
+		Eigen::Matrix4f view, proj;
+		camera().ComputeCameraMatrices(view, proj);
+		BenchmarkOccupiedCellTraversal(triangleBricks, view, proj, width(), height());
+	});
+
+	auto cmbVoxelResolution = new nanogui::ComboBox(mainWindow, { "128 Voxels", "256 Voxels", "512 Voxels", "1024 Voxels" });
+	auto voxelizeBtn = new nanogui::Button(mainWindow, "Voxelize Solid");
+	voxelizeBtn->setCallback([this, cmbVoxelResolution]() {
+		if (!polymesh.vertices_empty())
+			BenchmarkVoxelization(polymesh, triangleTree, 128 << cmbVoxelResolution->selectedIndex());
+	});
+
 	performLayout();
 }
 
@@ -126,6 +180,7 @@ void Viewer::MeshUpdated()
 	bboxMaxLength = bbox.diagonal().maxCoeff();
 
 	polymesh.triangulate();
+	renderer.ConnectivityChanged();
 	
 	BuildAABBTreeFromVertices(polymesh, vertexTree);
 	BuildAABBTreeFromEdges(polymesh, edgeTree);
@@ -135,6 +190,8 @@ void Viewer::MeshUpdated()
 	BuildHashGridFromVertices(polymesh, vertexGrid, cellSize);
 	BuildHashGridFromEdges(polymesh, edgeGrid, cellSize);
 	BuildHashGridFromTriangles(polymesh, triangleGrid, cellSize);		
+	BuildBrickGridFromTriangles(polymesh, triangleBricks, cellSize);
+	ReportGridMemoryUsage(triangleBricks, triangleGrid);
 
 	sldQuery->SetBounds(bbox.min, bbox.max);
 	sldQuery->SetValue(bbox.max);
@@ -242,6 +299,7 @@ void Viewer::drawContents()
 		camera().ComputeCameraMatrices(view, proj);
 		Eigen::Matrix4f mvp = proj * view;
 
+		renderer.BeginFrame();
 		if(chkRenderMesh->checked())
 			renderer.Render(view, proj, shadingBtn->selectedIndex() == 1);
 
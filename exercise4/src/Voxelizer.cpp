@@ -0,0 +1,203 @@
+// This source code is property of the Computer Graphics and Visualization
+// chair of the TU Dresden. Do not distribute!
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "Voxelizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <util/MeshIntegrals.h>
+#include <util/Parallel.h>
+
+//number of voxel columns processed by one task
+const size_t voxelColumnChunkSize = 64;
+//hits with a barycentric coordinate below this value lie on an edge or a vertex of the triangle
+const float boundaryHitTolerance = 1e-5f;
+
+typedef AABBTree<Triangle>::RayHit RayHit;
+
+//returns true if the hit lies on an edge or a vertex of the hit triangle
+static bool OnTriangleBoundary(const RayHit& hit)
+{
+	return hit.u < boundaryHitTolerance || hit.v < boundaryHitTolerance || 1 - hit.u - hit.v < boundaryHitTolerance;
+}
+
+//Merges the sorted hits of a ray into surface crossings. A ray through an edge or vertex hits all adjacent triangles
+//at the same parameter, such hits on the boundaries of triangles that share a vertex count as one crossing. Hits of
+//different surfaces (e.g. the two sides of a thin shell) are never merged, however close they are.
+//Returns false if merged triangles face in different directions along the ray, i.e. the ray only touches the surface.
+static bool MergeSurfaceCrossings(const std::vector<RayHit>& hits, const Eigen::Vector3f& dir, float tTolerance, std::vector<float>& crossings)
+{
+	crossings.clear();
+	for (size_t i = 0; i < hits.size();)
+	{
+		float facing = hits[i].primitive->Normal().dot(dir);
+		size_t j = i + 1;
+		if (OnTriangleBoundary(hits[i]))
+			while (j < hits.size() && hits[j].t - hits[i].t < tTolerance && OnTriangleBoundary(hits[j])
+				&& hits[j].primitive->SharesVertex(*hits[i].primitive))
+			{
+				if ((hits[j].primitive->Normal().dot(dir) > 0) != (facing > 0))
+					return false;
+				++j;
+			}
+		crossings.push_back(hits[i].t);
+		i = j;
+	}
+	return true;
+}
+
+SolidVoxelGrid::SolidVoxelGrid()
+	: resolution(Eigen::Vector3i::Zero()), origin(Eigen::Vector3f::Zero()), voxelSize(1), wordsPerColumn(0)
+{
+}
+
+void SolidVoxelGrid::Resize(const Eigen::Vector3i& resolution, const Eigen::Vector3f& origin, float voxelSize)
+{
+	this->resolution = resolution;
+	this->origin = origin;
+	this->voxelSize = voxelSize;
+	wordsPerColumn = (resolution.z() + 63) / 64;
+	bits.assign((size_t)resolution.x() * resolution.y() * wordsPerColumn, 0);
+}
+
+Eigen::Vector3f SolidVoxelGrid::VoxelCenter(int x, int y, int z) const
+{
+	return origin + voxelSize * Eigen::Vector3f(x + 0.5f, y + 0.5f, z + 0.5f);
+}
+
+bool SolidVoxelGrid::Inside(int x, int y, int z) const
+{
+	size_t column = ((size_t)y * resolution.x() + x) * wordsPerColumn;
+	return (bits[column + z / 64] >> (z % 64)) & 1;
+}
+
+void SolidVoxelGrid::SetColumnInside(int x, int y, int zBegin, int zEnd)
+{
+	std::uint64_t* column = &bits[((size_t)y * resolution.x() + x) * wordsPerColumn];
+	while (zBegin < zEnd)
+	{
+		int word = zBegin / 64;
+		int first = zBegin % 64;
+		int count = std::min(64 - first, zEnd - zBegin);
+		std::uint64_t mask = count == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << count) - 1) << first;
+		column[word] |= mask;
+		zBegin += count;
+	}
+}
+
+size_t SolidVoxelGrid::NumInsideVoxels() const
+{
+	std::vector<size_t> chunkCounts((bits.size() + 4095) / 4096, 0);
+	nse::util::ParallelForChunks(0, bits.size(), 4096, [&](size_t chunk, size_t begin, size_t end, unsigned int)
+	{
+		size_t count = 0;
+		for (size_t i = begin; i < end; ++i)
+			for (std::uint64_t word = bits[i]; word != 0; word &= word - 1)
+				++count;
+		chunkCounts[chunk] = count;
+	});
+	size_t count = 0;
+	for (auto c : chunkCounts)
+		count += c;
+	return count;
+}
+
+size_t VoxelizeSolid(const AABBTree<Triangle>& tree, int resolution, SolidVoxelGrid& grid)
+{
+	if (tree.Empty())
+	{
+		grid.Resize(Eigen::Vector3i::Zero(), Eigen::Vector3f::Zero(), 1);
+		return 0;
+	}
+	Box bounds = tree.Root()->GetBounds();
+	Eigen::Vector3f extents = bounds.Extents();
+	float voxelSize = extents.maxCoeff() / std::max(1, resolution - 2);
+	Eigen::Vector3i res;
+	for (int d = 0; d < 3; ++d)
+		res[d] = std::min(resolution, (int)std::ceil(extents[d] / voxelSize) + 2);
+	grid.Resize(res, bounds.LowerBound() - Eigen::Vector3f::Constant(voxelSize), voxelSize);
+
+	//offsets of the ray within the column that are tried if a ray hits the mesh in an edge or vertex
+	const Eigen::Vector2f jitter[] = { Eigen::Vector2f(0, 0), Eigen::Vector2f(0.0137f, 0.0071f), Eigen::Vector2f(-0.0093f, 0.0119f) };
+	const float tMax = res.z() * voxelSize;
+	const Eigen::Vector3f dir = Eigen::Vector3f::UnitZ();
+
+	size_t columns = (size_t)res.x() * res.y();
+	std::vector<std::vector<RayHit>> perThreadHits(nse::util::NumThreads());
+	std::vector<std::vector<float>> perThreadCrossings(nse::util::NumThreads());
+	std::vector<size_t> chunkUnresolved((columns + voxelColumnChunkSize - 1) / voxelColumnChunkSize, 0);
+	nse::util::ParallelForChunks(0, columns, voxelColumnChunkSize, [&](size_t chunk, size_t begin, size_t end, unsigned int thread)
+	{
+		auto& hits = perThreadHits[thread];
+		auto& crossings = perThreadCrossings[thread];
+		for (size_t column = begin; column < end; ++column)
+		{
+			int x = (int)(column % res.x());
+			int y = (int)(column / res.x());
+			bool resolved = false;
+			for (auto& offset : jitter)
+			{
+				Eigen::Vector3f o = grid.VoxelCenter(x, y, 0);
+				o.x() += offset.x() * voxelSize;
+				o.y() += offset.y() * voxelSize;
+				o.z() = grid.Origin().z();
+
+				hits.clear();
+				tree.AllIntersections(o, dir, 0, tMax, hits);
+				std::sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.t < b.t; });
+				if (MergeSurfaceCrossings(hits, dir, 1e-4f * voxelSize, crossings) && crossings.size() % 2 == 0)
+				{
+					resolved = true;
+					break;
+				}
+			}
+			if (!resolved)
+			{
+				++chunkUnresolved[chunk];
+				continue;
+			}
+
+			//voxels whose centers lie between the entry and exit of a pair of crossings are inside
+			for (size_t i = 0; i < crossings.size(); i += 2)
+			{
+				int zBegin = std::max(0, (int)std::ceil(crossings[i] / voxelSize - 0.5f));
+				int zEnd = std::min(res.z(), (int)std::ceil(crossings[i + 1] / voxelSize - 0.5f));
+				grid.SetColumnInside(x, y, zBegin, zEnd);
+			}
+		}
+	});
+
+	size_t unresolved = 0;
+	for (auto c : chunkUnresolved)
+		unresolved += c;
+	return unresolved;
+}
+
+void BenchmarkVoxelization(const HEMesh& m, const AABBTree<Triangle>& tree, int resolution)
+{
+	if (tree.Empty())
+		return;
+	std::cout << "Voxelizing with resolution " << resolution << " using " << nse::util::NumThreads() << " threads .." << std::endl;
+
+	SolidVoxelGrid grid;
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	size_t unresolved = VoxelizeSolid(tree, resolution, grid);
+	auto timeEnd = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(timeEnd - timeStart).count();
+
+	auto& res = grid.Resolution();
+	double voxels = (double)res.x() * res.y() * res.z();
+	std::cout << "Voxelized " << res.x() << " x " << res.y() << " x " << res.z() << " voxels in " << seconds * 1000 << " ms ("
+		<< voxels / seconds * 1e-6 << " million voxels/s), using " << grid.MemoryUsage() / (1024.0 * 1024.0) << " MB." << std::endl;
+	if (unresolved > 0)
+		std::cout << unresolved << " voxel columns had an odd number of intersections and were left empty." << std::endl;
+
+	double voxelVolume = grid.NumInsideVoxels() * grid.VoxelVolume();
+	double meshVolume = ComputeMeshIntegrals(m).volume;
+	std::cout << "Voxel volume: " << voxelVolume << ", mesh volume: " << meshVolume
+		<< ", relative difference: " << std::abs(voxelVolume - meshVolume) / std::abs(meshVolume) << std::endl;
+}
@@ -3,15 +3,59 @@
 // Copyright (C) CGV TU Dresden - All Rights Reserved
 
 #include <iostream>
+#include <string>
 
 #include <util/GLDebug.h>
+#include <gui/Camera.h>
+#include <OpenMesh/Core/IO/MeshIO.hh>
 
 #include "Viewer.h"
+#include "RayCaster.h"
+
+//renders depth, normal and face id images of a mesh without opening a window
+int RenderHeadless(const std::string& meshFile, const std::string& outputPrefix, int width, int height)
+{
+	HEMesh mesh;
+	if (!OpenMesh::IO::read_mesh(mesh, meshFile))
+	{
+		std::cerr << "The specified file could not be loaded" << std::endl;
+		return 1;
+	}
+	mesh.triangulate();
+
+	AABBTree<Triangle> tree;
+	BuildAABBTreeFromTriangles(mesh, tree);
+
+	//the camera only queries the size of its widget, which does not need a window
+	nanogui::ref<nanogui::Widget> canvas = new nanogui::Widget(nullptr);
+	canvas->setSize(Eigen::Vector2i(width, height));
+	nse::gui::Camera camera(*canvas);
+	nse::math::BoundingBox<float, 3> bbox;
+	for (auto v : mesh.vertices())
+		bbox.expand(ToEigenVector(mesh.point(v)));
+	camera.FocusOnBBox(bbox);
+
+	Eigen::Matrix4f view, proj;
+	camera.ComputeCameraMatrices(view, proj);
+
+	bool passed = BenchmarkRayCaster(tree, view, proj, width, height);
+
+	RayCastImages images;
+	RayCast(tree, view, proj, width, height, images);
+	return images.Save(outputPrefix) && passed ? 0 : 1;
+}
 
 int main(int argc, char* argv[])
 {
 	std::cout.imbue(std::locale(""));
 
+	if (argc >= 4 && std::string(argv[1]) == "--render")
+	{
+		int width = argc >= 6 ? std::stoi(argv[4]) : 1024;
+		int height = argc >= 6 ? std::stoi(argv[5]) : 768;
+		return RenderHeadless(argv[2], argv[3], width, height);
+	}
+
 	nanogui::init();
 
 	{		
@@ -7,6 +7,7 @@
 #include <Eigen/Sparse>
 #include <Eigen/SparseLU>
 #include <iostream>
+#include <util/LaplacianMatrix.h>
 
 bool IsTopologicalDisk(const HEMesh& m, OpenMesh::HalfedgeHandle& outBoundary)
 {
@@ -53,22 +54,22 @@ bool IsTopologicalDisk(const HEMesh& m, OpenMesh::HalfedgeHandle& outBoundary)
 
 template<> float Weight<CONSTANT_WEIGHT>(HEMesh& m, OpenMesh::HalfedgeHandle h)
 {
-	return 0;
+	return (float)LaplacianWeight(m, h, LaplacianWeights::Uniform);
 }
 
 template<> float Weight<EDGE_LENGTH_WEIGHT>(HEMesh& m, OpenMesh::HalfedgeHandle h)
 {
-	return 0;
+	return (float)LaplacianWeight(m, h, LaplacianWeights::EdgeLength);
 }
 
 template<> float Weight<INV_EDGE_LENGTH_WEIGHT>(HEMesh& m, OpenMesh::HalfedgeHandle h)
 {
-	return 0;
+	return (float)LaplacianWeight(m, h, LaplacianWeights::InverseEdgeLength);
 }
 
 template<> float Weight<COTAN_WEIGHT>(HEMesh& m, OpenMesh::HalfedgeHandle h)
 {
-	return 0;
+	return (float)LaplacianWeight(m, h, LaplacianWeights::Cotangent);
 }
 
 template <WeightType wtype>
@@ -197,6 +197,7 @@ void Viewer::MeshUpdated()
 		camera().FocusOnBBox(meshBbox);
 
 	polymesh.triangulate();	
+	renderer.ConnectivityChanged();
 	correspondences.clear();
 	
 	hasParametrization = false;
@@ -242,6 +243,7 @@ void Viewer::drawContents()
 		camera().ComputeCameraMatrices(view, proj);
 		Eigen::Matrix4f mvp = proj * view;
 
+		renderer.BeginFrame();
 		renderer.Render(view, proj, shadingBtn->selectedIndex() == 1, hasParametrization);
 
 		if (chkRenderSecondMesh->checked())